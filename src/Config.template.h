@@ -105,6 +105,8 @@
 
 #define STAMPS_DIR "stamps"
 
+#define THUMBNAIL_CACHE_DIR "thumbnails"
+
 #define BRUSH_DIR "Brushes"
 
 #ifndef M_GRAV
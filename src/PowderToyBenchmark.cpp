@@ -0,0 +1,296 @@
+#include "Config.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "common/Platform.h"
+#include "common/String.h"
+#include "common/tpt-rand.h"
+#include "graphics/Graphics.h"
+#include "graphics/Renderer.h"
+#include "gui/game/RenderPreset.h"
+
+#include "client/GameSave.h"
+#include "simulation/Air.h"
+#include "simulation/ElementClasses.h"
+#include "simulation/Gravity.h"
+#include "simulation/Simulation.h"
+#include "simulation/SimulationData.h"
+
+
+void EngineProcess() {}
+void ClipboardPush(ByteString) {}
+ByteString ClipboardPull() { return ""; }
+int GetModifiers() { return 0; }
+void SetCursorEnabled(int enabled) {}
+unsigned int GetTicks() { return 0; }
+
+static bool readFile(ByteString filename, std::vector<char> & storage)
+{
+	std::ifstream fileStream;
+	fileStream.open(filename.c_str(), std::ios::binary);
+	if (!fileStream.is_open())
+		return false;
+	fileStream.seekg(0, std::ios::end);
+	size_t fileSize = fileStream.tellg();
+	fileStream.seekg(0);
+	storage.resize(fileSize);
+	fileStream.read(&storage[0], fileSize);
+	return bool(fileStream);
+}
+
+// times whole frames of each render preset on what the simulation holds now,
+// including persistent display and fire, which build up over frames
+static void benchmarkRenderPresets(Renderer * ren, int frames)
+{
+	std::cout << "  " << std::left << std::setw(30) << "render preset" << std::right << std::setw(12) << "ms/frame" << std::endl;
+	for (auto &preset : ren->renderModePresets)
+	{
+		ren->SetRenderMode(preset.RenderModes);
+		ren->SetDisplayMode(preset.DisplayModes);
+		ren->SetColourMode(preset.ColourMode);
+		ren->ClearAccumulation();
+		auto start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; frame++)
+		{
+			ren->clearScreen(1.0f);
+			ren->RenderBegin();
+			ren->RenderEnd();
+		}
+		std::chrono::steady_clock::duration total = std::chrono::steady_clock::now() - start;
+		std::cout << "  " << std::left << std::setw(30) << preset.Name.ToUtf8() << std::right
+		          << std::setw(12) << std::fixed << std::setprecision(2)
+		          << std::chrono::duration<double, std::milli>(total).count() / frames << std::endl;
+		std::cout.unsetf(std::ios::floatfield);
+	}
+	ren->ResetModes();
+}
+
+// draws one frame of each render preset without tile threads and with the
+// renderer's, and reports the presets whose pictures differ at all
+static bool compareTileRendering(Renderer * ren)
+{
+	int tileThreads = ren->GetTileThreads();
+	bool identical = true;
+	for (auto &preset : ren->renderModePresets)
+	{
+		ren->SetRenderMode(preset.RenderModes);
+		ren->SetDisplayMode(preset.DisplayModes);
+		ren->SetColourMode(preset.ColourMode);
+		auto drawFrame = [ren](int threads) {
+			ren->SetTileThreads(threads);
+			ren->ClearAccumulation();
+			random_gen.seed(0);
+			ren->clearScreen(1.0f);
+			ren->RenderBegin();
+			ren->RenderEnd();
+			return ren->DumpFrame();
+		};
+		VideoBuffer serial = drawFrame(0);
+		VideoBuffer tiled = drawFrame(tileThreads);
+		int size = serial.Width * serial.Height;
+		int offset = std::mismatch(serial.Buffer, serial.Buffer + size, tiled.Buffer).first - serial.Buffer;
+		if (offset != size)
+		{
+			std::cerr << "  " << preset.Name.ToUtf8() << ": " << tileThreads << " tile threads differ from none at "
+			          << offset % serial.Width << "," << offset / serial.Width << std::endl;
+			identical = false;
+		}
+	}
+	ren->ResetModes();
+	ren->SetTileThreads(tileThreads);
+	return identical;
+}
+
+static bool benchmarkSave(Simulation * sim, Renderer * ren, ByteString filename, int warmupFrames, int frames)
+{
+	std::vector<char> saveData;
+	if (!readFile(filename, saveData))
+	{
+		std::cerr << filename << ": could not read" << std::endl;
+		return false;
+	}
+	GameSave * save;
+	try
+	{
+		save = new GameSave(std::move(saveData), false);
+	}
+	catch (ParseException &e)
+	{
+		std::cerr << filename << ": " << e.what() << std::endl;
+		return false;
+	}
+
+	// same seed for every save so runs are comparable
+	RNG::Ref().seed(0);
+	random_gen.seed(0);
+	sim->clear_sim();
+	sim->gravityMode = save->gravityMode;
+	sim->air->airMode = save->airMode;
+	sim->air->ambientAirTemp = save->ambientAirTemp;
+	sim->edgeMode = save->edgeMode;
+	sim->legacy_enable = save->legacyEnable;
+	sim->water_equal_test = save->waterEEnabled;
+	sim->aheat_enable = save->aheatEnable;
+	if (save->gravityEnable)
+		sim->grav->start_grav_async();
+	else
+		sim->grav->stop_grav_async();
+	int loadFailed = sim->Load(save, true);
+	delete save;
+	if (loadFailed)
+	{
+		std::cerr << filename << ": could not load" << std::endl;
+		return false;
+	}
+	sim->sys_pause = 0;
+	ren->ClearAccumulation();
+
+	uint64_t particleFrames = 0;
+	for (int frame = 0; frame < warmupFrames + frames; frame++)
+	{
+		if (frame == warmupFrames)
+		{
+			sim->timings.Reset();
+			sim->timings.enabled = true;
+		}
+		sim->BeforeSim();
+		sim->UpdateParticles(0, NPART);
+		sim->AfterSim();
+		ren->clearScreen(1.0f);
+		ren->render_parts();
+		if (frame >= warmupFrames)
+			particleFrames += sim->NUM_PARTS;
+	}
+	sim->timings.enabled = false;
+
+	double frameTotal = 0;
+	for (int phase = 0; phase < SimulationTimings::PHASE_NUM; phase++)
+		frameTotal += sim->timings.nanoseconds[phase] / 1e6;
+	std::cout << filename << ": " << particleFrames / frames << " particles, "
+	          << frameTotal / frames << " ms/frame" << std::endl;
+	std::cout << "  " << std::left << std::setw(14) << "phase" << std::right
+	          << std::setw(8) << "calls" << std::setw(12) << "total ms"
+	          << std::setw(12) << "ms/frame" << std::setw(14) << "ns/particle" << std::endl;
+	for (int phase = 0; phase < SimulationTimings::PHASE_NUM; phase++)
+	{
+		uint64_t nanoseconds = sim->timings.nanoseconds[phase];
+		std::cout << "  " << std::left << std::setw(14) << SimulationTimings::PhaseName(phase) << std::right
+		          << std::setw(8) << sim->timings.calls[phase]
+		          << std::setw(12) << std::fixed << std::setprecision(2) << nanoseconds / 1e6
+		          << std::setw(12) << nanoseconds / 1e6 / frames
+		          << std::setw(14) << (particleFrames ? double(nanoseconds) / particleFrames : 0.0) << std::endl;
+		std::cout.unsetf(std::ios::floatfield);
+	}
+	benchmarkRenderPresets(ren, frames);
+	if (ren->GetTileThreads() && !compareTileRendering(ren))
+	{
+		std::cerr << filename << ": tile rendering does not match serial rendering" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// times each flood fill over the whole simulation area, setting it up again
+// before every run
+static void benchmarkFloodFills(Simulation * sim, int runs)
+{
+	auto fillArea = [sim](int type) {
+		sim->clear_sim();
+		for (int y = CELL; y < YRES-CELL; y++)
+			for (int x = CELL; x < XRES-CELL; x++)
+				sim->create_part(-1, x, y, type);
+	};
+	auto timeFill = [runs](const char * name, std::function<void ()> setup, std::function<void ()> fill) {
+		std::chrono::steady_clock::duration total(0);
+		for (int run = 0; run < runs; run++)
+		{
+			setup();
+			auto start = std::chrono::steady_clock::now();
+			fill();
+			total += std::chrono::steady_clock::now() - start;
+		}
+		std::cout << "  " << std::left << std::setw(14) << name << std::right
+		          << std::setw(12) << std::fixed << std::setprecision(2)
+		          << std::chrono::duration<double, std::milli>(total).count() / runs << std::endl;
+		std::cout.unsetf(std::ios::floatfield);
+	};
+
+	std::cout << "flood fills: " << (XRES-2*CELL)*(YRES-2*CELL) << " pixels" << std::endl;
+	std::cout << "  " << std::left << std::setw(14) << "fill" << std::right << std::setw(12) << "ms/fill" << std::endl;
+	timeFill("flood_prop", [&]() { fillArea(PT_DUST); }, [sim]() {
+		PropertyValue value;
+		value.Float = 500.0f;
+		sim->flood_prop(XRES/2, YRES/2, offsetof(Particle, temp), value, StructProperty::Float);
+	});
+	timeFill("FloodINST", [&]() { fillArea(PT_INST); }, [sim]() {
+		sim->FloodINST(XRES/2, YRES/2);
+	});
+	// no free space anywhere, so the whole body of water is searched
+	timeFill("flood_water", [&]() { fillArea(PT_WATR); }, [sim]() {
+		sim->flood_water(XRES/2, YRES/2, ID(sim->pmap[YRES/2][XRES/2]));
+	});
+	timeFill("FloodWalls", [sim]() { sim->clear_sim(); }, [sim]() {
+		sim->FloodWalls(XRES/2, YRES/2, WL_WALL, -1);
+	});
+}
+
+#ifdef main
+# undef main // thank you sdl
+#endif
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2)
+	{
+		std::cout << "Usage: " << argv[0] << " <saveDirectory> [frames] [warmupFrames] [airThreads] [heatThreads] [renderThreads]" << std::endl;
+		return 1;
+	}
+	ByteString directory = argv[1];
+	int frames = argc > 2 ? atoi(argv[2]) : 200;
+	int warmupFrames = argc > 3 ? atoi(argv[3]) : 20;
+	int airThreads = argc > 4 ? atoi(argv[4]) : 1;
+	int heatThreads = argc > 5 ? atoi(argv[5]) : 0;
+	int renderThreads = argc > 6 ? atoi(argv[6]) : 0;
+	if (frames <= 0)
+	{
+		std::cerr << "frames must be positive" << std::endl;
+		return 1;
+	}
+
+	std::vector<ByteString> saves = Platform::DirectorySearch(directory, "", { ".cps", ".stm" });
+	if (!saves.size())
+	{
+		std::cerr << "No saves found in " << directory << std::endl;
+		return 1;
+	}
+	std::sort(saves.begin(), saves.end());
+	if (*directory.rbegin() != '/' && *directory.rbegin() != '\\')
+		directory += PATH_SEP;
+
+	Simulation * sim = new Simulation();
+	sim->air->SetThreads(airThreads);
+	sim->SetParallelHeat(heatThreads);
+	Renderer * ren = new Renderer(new Graphics(), sim);
+	ren->decorations_enable = true;
+	ren->SetTileThreads(renderThreads);
+
+	int failed = 0;
+	for (auto &save : saves)
+	{
+		if (!benchmarkSave(sim, ren, directory + save, warmupFrames, frames))
+			failed++;
+	}
+	benchmarkFloodFills(sim, 10);
+
+	delete ren;
+	delete sim;
+	return failed ? 1 : 0;
+}
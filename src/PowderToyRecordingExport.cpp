@@ -0,0 +1,70 @@
+#include "Config.h"
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "common/String.h"
+#include "Format.h"
+#include "graphics/Graphics.h"
+#include "graphics/Recording.h"
+
+
+void EngineProcess() {}
+void ClipboardPush(ByteString) {}
+ByteString ClipboardPull() { return ""; }
+int GetModifiers() { return 0; }
+void SetCursorEnabled(int enabled) {}
+unsigned int GetTicks() { return 0; }
+
+#ifdef main
+# undef main // thank you sdl
+#endif
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3)
+	{
+		std::cout << "Usage: " << argv[0] << " <recording> <outputPrefix> [png|ppm]" << std::endl;
+		return 1;
+	}
+	ByteString inputFilename = argv[1];
+	ByteString outputPrefix = argv[2];
+	ByteString extension = argc > 3 ? argv[3] : "png";
+	if (extension != "png" && extension != "ppm")
+	{
+		std::cerr << "Unknown format " << extension << std::endl;
+		return 1;
+	}
+
+	RecordingReader reader(inputFilename);
+	if (!reader.IsOpen())
+	{
+		std::cerr << "Could not read " << inputFilename << std::endl;
+		return 1;
+	}
+
+	// same names the recorder used to write directly
+	VideoBuffer frame(reader.GetWidth(), reader.GetHeight());
+	std::vector<pixel> pixels;
+	int frameIndex = 0;
+	while (reader.ReadFrame(pixels))
+	{
+		std::copy(pixels.begin(), pixels.end(), frame.Buffer);
+		std::vector<char> data = extension == "png" ? format::VideoBufferToPNG(frame) : format::VideoBufferToPPM(frame);
+		ByteString filename = ByteString::Build(outputPrefix, "frame_", Format::Width(frameIndex++, 6), ".", extension);
+		std::ofstream fileStream(filename.c_str(), std::ios::binary);
+		if (!fileStream.write(&data[0], data.size()))
+		{
+			std::cerr << "Could not write " << filename << std::endl;
+			return 1;
+		}
+	}
+	if (reader.IsDamaged())
+	{
+		std::cerr << inputFilename << " is truncated or damaged after " << frameIndex << " frames" << std::endl;
+		return 1;
+	}
+	std::cout << frameIndex << " frames" << std::endl;
+	return 0;
+}
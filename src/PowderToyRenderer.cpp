@@ -83,7 +83,7 @@ int main(int argc, char *argv[])
 	GameSave * gameSave = NULL;
 	try
 	{
-		gameSave = new GameSave(inputFile);
+		gameSave = new GameSave(std::move(inputFile), false);
 	}
 	catch (ParseException &e)
 	{
@@ -0,0 +1,216 @@
+#include "Config.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "common/String.h"
+#include "common/tpt-rand.h"
+
+#include "client/GameSave.h"
+#include "simulation/Air.h"
+#include "simulation/Gravity.h"
+#include "simulation/Simulation.h"
+
+
+void EngineProcess() {}
+void ClipboardPush(ByteString) {}
+ByteString ClipboardPull() { return ""; }
+int GetModifiers() { return 0; }
+void SetCursorEnabled(int enabled) {}
+unsigned int GetTicks() { return 0; }
+
+static bool readFile(ByteString filename, std::vector<char> & storage)
+{
+	std::ifstream fileStream;
+	fileStream.open(filename.c_str(), std::ios::binary);
+	if (!fileStream.is_open())
+		return false;
+	fileStream.seekg(0, std::ios::end);
+	size_t fileSize = fileStream.tellg();
+	fileStream.seekg(0);
+	storage.resize(fileSize);
+	fileStream.read(&storage[0], fileSize);
+	return bool(fileStream);
+}
+
+// 64-bit FNV-1a, good enough to notice any behaviour drift between runs
+static uint64_t hashBytes(const void * data, size_t size, uint64_t hash = 0xCBF29CE484222325ULL)
+{
+	auto bytes = reinterpret_cast<const unsigned char *>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static uint64_t hashParts(Simulation * sim)
+{
+	// only hash up to the last active particle so the hash doesn't depend on
+	// the state of unused slots past the end of the particle list, and hash
+	// property by property so it doesn't depend on the layout of Particle either
+	int count = sim->parts_lastActiveIndex + 1;
+	uint64_t hash = hashBytes(&count, sizeof(count));
+	auto &properties = Particle::GetProperties();
+	for (int i = 0; i < count; i++)
+	{
+		auto part = reinterpret_cast<const char *>(&sim->parts[i]);
+		for (auto &property : properties)
+			hash = hashBytes(part + property.Offset, sizeof(int), hash);
+	}
+	return hash;
+}
+
+static uint64_t hashAir(Simulation * sim)
+{
+	uint64_t hash = hashBytes(sim->air->pv, sizeof(sim->air->pv));
+	hash = hashBytes(sim->air->vx, sizeof(sim->air->vx), hash);
+	hash = hashBytes(sim->air->vy, sizeof(sim->air->vy), hash);
+	return hashBytes(sim->air->hv, sizeof(sim->air->hv), hash);
+}
+
+#ifdef main
+# undef main // thank you sdl
+#endif
+
+struct RunResult
+{
+	// the hashes of the simulation state after each frame
+	std::vector<ByteString> frameHashes;
+	double seconds;
+	int particles;
+};
+
+static bool runSave(const std::vector<char> & inputFile, ByteString inputFilename, int frames, unsigned int seed, int airThreads, int heatThreads, bool vectorisedAir, RunResult & result)
+{
+	// parsed again for every run so that no run sees what an earlier one did to the save
+	GameSave * gameSave = NULL;
+	try
+	{
+		gameSave = new GameSave(std::vector<char>(inputFile), false);
+	}
+	catch (ParseException &e)
+	{
+		std::cerr << "Could not parse " << inputFilename << ": " << e.what() << std::endl;
+		return false;
+	}
+
+	// seed both generators before loading, Air::RecalculateBlockAirMaps already uses random_gen
+	RNG::Ref().seed(seed);
+	random_gen.seed(seed);
+
+	Simulation * sim = new Simulation();
+	sim->air->SetThreads(airThreads);
+	sim->air->vectorised = vectorisedAir;
+	sim->SetParallelHeat(heatThreads);
+	sim->gravityMode = gameSave->gravityMode;
+	sim->air->airMode = gameSave->airMode;
+	sim->air->ambientAirTemp = gameSave->ambientAirTemp;
+	sim->edgeMode = gameSave->edgeMode;
+	sim->legacy_enable = gameSave->legacyEnable;
+	sim->water_equal_test = gameSave->waterEEnabled;
+	sim->aheat_enable = gameSave->aheatEnable;
+	// wait for each gravity update instead of picking it up whenever the thread happens to finish
+	sim->grav->SetSynchronous(true);
+	if (gameSave->gravityEnable)
+		sim->grav->start_grav_async();
+	if (sim->Load(gameSave, true))
+	{
+		std::cerr << "Could not load " << inputFilename << std::endl;
+		delete sim;
+		delete gameSave;
+		return false;
+	}
+	sim->sys_pause = 0;
+
+	// hashing is left out of the timing so the fps figure is the simulation's alone
+	std::chrono::steady_clock::duration simTime(0);
+	result.frameHashes.clear();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		sim->BeforeSim();
+		sim->UpdateParticles(0, NPART);
+		sim->AfterSim();
+		simTime += std::chrono::steady_clock::now() - start;
+
+		std::ostringstream hashes;
+		hashes << std::hex << std::setfill('0')
+		       << "parts " << std::setw(16) << hashParts(sim)
+		       << " pmap " << std::setw(16) << hashBytes(sim->pmap, sizeof(sim->pmap))
+		       << " air " << std::setw(16) << hashAir(sim);
+		result.frameHashes.push_back(hashes.str());
+	}
+	result.seconds = std::chrono::duration<double>(simTime).count();
+	result.particles = sim->NUM_PARTS;
+
+	delete sim;
+	delete gameSave;
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2)
+	{
+		std::cout << "Usage: " << argv[0] << " <inputFilename> [frames] [seed] [airThreads] [heatThreads] [vector|scalar|compare]" << std::endl;
+		return 1;
+	}
+	ByteString inputFilename = argv[1];
+	int frames = argc > 2 ? atoi(argv[2]) : 100;
+	unsigned int seed = argc > 3 ? (unsigned int)strtoul(argv[3], NULL, 10) : 0;
+	int airThreads = argc > 4 ? atoi(argv[4]) : 1;
+	// 0 keeps heat conduction in the particle loop
+	int heatThreads = argc > 5 ? atoi(argv[5]) : 0;
+	// which air kernels to use, compare runs the save with both and reports
+	// the first frame where they disagree
+	ByteString airKernels = argc > 6 ? argv[6] : "vector";
+	if (airKernels != "vector" && airKernels != "scalar" && airKernels != "compare")
+	{
+		std::cerr << "Unknown air kernels " << airKernels << std::endl;
+		return 1;
+	}
+
+	std::vector<char> inputFile;
+	if (!readFile(inputFilename, inputFile))
+	{
+		std::cerr << "Could not read " << inputFilename << std::endl;
+		return 1;
+	}
+
+	RunResult result;
+	if (!runSave(inputFile, inputFilename, frames, seed, airThreads, heatThreads, airKernels != "scalar", result))
+		return 1;
+	for (int frame = 0; frame < frames; frame++)
+		std::cout << frame << " " << result.frameHashes[frame] << "\n";
+	std::cout << std::flush;
+
+	std::cerr << frames << " frames, " << result.particles << " particles, " << result.seconds << " s";
+	if (result.seconds > 0)
+		std::cerr << ", " << frames / result.seconds << " fps";
+	std::cerr << std::endl;
+
+	if (airKernels == "compare")
+	{
+		RunResult scalarResult;
+		if (!runSave(inputFile, inputFilename, frames, seed, airThreads, heatThreads, false, scalarResult))
+			return 1;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			if (scalarResult.frameHashes[frame] != result.frameHashes[frame])
+			{
+				std::cerr << "Scalar air kernels differ from frame " << frame << ": " << scalarResult.frameHashes[frame] << std::endl;
+				return 1;
+			}
+		}
+		std::cerr << "Scalar air kernels match for all " << frames << " frames" << std::endl;
+	}
+	return 0;
+}
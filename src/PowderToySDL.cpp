@@ -926,7 +926,7 @@ int main(int argc, char * argv[])
 					else
 					{
 						SaveFile * newFile = new SaveFile(filename);
-						GameSave * newSave = new GameSave(gameSaveData);
+						GameSave * newSave = new GameSave((char *)gameSaveData.data(), gameSaveData.size());
 						newFile->SetDisplayName(arguments["open"].FromUtf8());
 						newFile->SetGameSave(newSave);
 						gameController->LoadSaveFile(newFile);
@@ -982,7 +982,7 @@ int main(int argc, char * argv[])
 				std::vector<unsigned char> saveData = Client::Ref().GetSaveData(saveId, 0);
 				if (!saveData.size())
 					throw std::runtime_error(("Could not load save\n" + Client::Ref().GetLastError()).ToUtf8());
-				GameSave * newGameSave = new GameSave(saveData);
+				GameSave * newGameSave = new GameSave((char *)saveData.data(), saveData.size());
 				newSave->SetGameSave(newGameSave);
 
 				gameController->LoadSave(newSave);
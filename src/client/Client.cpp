@@ -35,6 +35,7 @@
 #include "client/GameSave.h"
 #include "client/SaveFile.h"
 #include "client/SaveInfo.h"
+#include "client/ThumbnailCache.h"
 #include "client/UserInfo.h"
 #include "common/Platform.h"
 #include "common/String.h"
@@ -489,14 +490,10 @@ std::vector<unsigned char> Client::ReadFile(ByteString filename)
 			size_t fileSize = fileStream.tellg();
 			fileStream.seekg(0);
 
-			unsigned char * tempData = new unsigned char[fileSize];
-			fileStream.read((char *)tempData, fileSize);
+			std::vector<unsigned char> fileData(fileSize);
+			fileStream.read((char *)fileData.data(), fileSize);
 			fileStream.close();
 
-			std::vector<unsigned char> fileData;
-			fileData.insert(fileData.end(), tempData, tempData+fileSize);
-			delete[] tempData;
-
 			return fileData;
 		}
 		else
@@ -935,6 +932,7 @@ void Client::DeleteStamp(ByteString stampID)
 		{
 			ByteString stampFilename = ByteString::Build(STAMPS_DIR, PATH_SEP, stampID, ".stm");
 			remove(stampFilename.c_str());
+			ThumbnailCache::Invalidate(stampFilename);
 			stampIDs.erase(iterator);
 			break;
 		}
@@ -971,7 +969,8 @@ ByteString Client::AddStamp(GameSave * saveData)
 	saveData->authors = stampInfo;
 
 	unsigned int gameDataLength;
-	char * gameData = saveData->Serialise(gameDataLength);
+	// stamps are never uploaded as they are, so they can use the fast codec
+	char * gameData = saveData->Serialise(gameDataLength, true);
 	if (gameData == NULL)
 		return "";
 
@@ -982,6 +981,9 @@ ByteString Client::AddStamp(GameSave * saveData)
 
 	delete[] gameData;
 
+	// stamp names are reused if a stamp was deleted in the same second
+	ThumbnailCache::Invalidate(filename);
+
 	stampIDs.push_front(saveID);
 
 	updateStamps();
@@ -1358,14 +1360,19 @@ SaveInfo * Client::GetSave(int saveID, int saveDate)
 	return NULL;
 }
 
-SaveFile * Client::LoadSaveFile(ByteString filename)
+SaveFile * Client::LoadSaveFile(ByteString filename, bool collapse)
 {
 	if (!Platform::FileExists(filename))
 		return nullptr;
 	SaveFile * file = new SaveFile(filename);
 	try
 	{
-		GameSave * tempSave = new GameSave(ReadFile(filename));
+		std::vector<unsigned char> fileData = ReadFile(filename);
+		GameSave * tempSave;
+		if (collapse)
+			tempSave = new GameSave(fileData);
+		else
+			tempSave = new GameSave((char *)fileData.data(), fileData.size());
 		file->SetGameSave(tempSave);
 	}
 	catch (const ParseException &e)
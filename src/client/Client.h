@@ -143,7 +143,9 @@ public:
 	std::vector<std::pair<ByteString, int> > * GetTags(int start, int count, String query, int & resultCount);
 
 	SaveInfo * GetSave(int saveID, int saveDate);
-	SaveFile * LoadSaveFile(ByteString filename);
+	// collapse false parses the file data in place and keeps only the parsed
+	// save, for callers that load it into the simulation right away
+	SaveFile * LoadSaveFile(ByteString filename, bool collapse = true);
 
 	RequestStatus DeleteSave(int saveID);
 	RequestStatus ReportSave(int saveID, String message);
@@ -8,6 +8,7 @@
 #include <cmath>
 
 #include "bzip2/bzlib.h"
+#include "lz/lz.h"
 #include "Config.h"
 #include "Format.h"
 #include "hmap.h"
@@ -17,6 +18,11 @@
 
 #include "common/tpt-minmax.h"
 
+// the fourth byte of an OPS header says how the data after the header is
+// compressed; only bzip2 saves can be uploaded or opened by other versions
+#define OPS_BZIP2 '1'
+#define OPS_LZ 'L'
+
 GameSave::GameSave(GameSave & save):
     majorVersion(save.majorVersion),
 	waterEEnabled(save.waterEEnabled),
@@ -43,17 +49,14 @@ GameSave::GameSave(GameSave & save):
 	{
 		setSize(save.blockWidth, save.blockHeight);
 
-		std::copy(save.particles, save.particles+NPART, particles);
-		for (int j = 0; j < blockHeight; j++)
-		{
-			std::copy(save.blockMap[j], save.blockMap[j]+blockWidth, blockMap[j]);
-			std::copy(save.fanVelX[j], save.fanVelX[j]+blockWidth, fanVelX[j]);
-			std::copy(save.fanVelY[j], save.fanVelY[j]+blockWidth, fanVelY[j]);
-			std::copy(save.pressure[j], save.pressure[j]+blockWidth, pressure[j]);
-			std::copy(save.velocityX[j], save.velocityX[j]+blockWidth, velocityX[j]);
-			std::copy(save.velocityY[j], save.velocityY[j]+blockWidth, velocityY[j]);
-			std::copy(save.ambientHeat[j], save.ambientHeat[j]+blockWidth, ambientHeat[j]);
-		}
+		std::copy(save.particles, save.particles+save.particlesCount, particles);
+		blockMap = save.blockMap;
+		fanVelX = save.fanVelX;
+		fanVelY = save.fanVelY;
+		pressure = save.pressure;
+		velocityX = save.velocityX;
+		velocityY = save.velocityY;
+		ambientHeat = save.ambientHeat;
 	}
 	else
 	{
@@ -73,30 +76,19 @@ GameSave::GameSave(int width, int height)
 	setSize(width, height);
 }
 
-GameSave::GameSave(std::vector<char> data)
+GameSave::GameSave(std::vector<char> data, bool collapse):
+	originalData(std::move(data))
 {
-	blockWidth = 0;
-	blockHeight = 0;
+	InitFromOriginalData(collapse);
+}
 
-	InitData();
-	InitVars();
-	expanded = false;
-	hasOriginalData = true;
-	originalData = data;
-	try
-	{
-		Expand();
-	}
-	catch(ParseException & e)
-	{
-		std::cout << e.what() << std::endl;
-		dealloc();	//Free any allocated memory
-		throw;
-	}
-	Collapse();
+GameSave::GameSave(const std::vector<unsigned char> &data, bool collapse):
+	originalData(data.begin(), data.end())
+{
+	InitFromOriginalData(collapse);
 }
 
-GameSave::GameSave(std::vector<unsigned char> data)
+void GameSave::InitFromOriginalData(bool collapse)
 {
 	blockWidth = 0;
 	blockHeight = 0;
@@ -105,7 +97,6 @@ GameSave::GameSave(std::vector<unsigned char> data)
 	InitVars();
 	expanded = false;
 	hasOriginalData = true;
-	originalData = std::vector<char>(data.begin(), data.end());
 	try
 	{
 		Expand();
@@ -116,7 +107,8 @@ GameSave::GameSave(std::vector<unsigned char> data)
 		dealloc();	//Free any allocated memory
 		throw;
 	}
-	Collapse();
+	if (collapse)
+		Collapse();
 }
 
 GameSave::GameSave(char * data, int dataSize)
@@ -126,15 +118,14 @@ GameSave::GameSave(char * data, int dataSize)
 
 	InitData();
 	InitVars();
-	expanded = false;
-	hasOriginalData = true;
-	originalData = std::vector<char>(data, data+dataSize);
+	expanded = true;
+	hasOriginalData = false;
 #ifdef DEBUG
 	std::cout << "Creating Expanded save from data" << std::endl;
 #endif
 	try
 	{
-		Expand();
+		read(data, dataSize);
 	}
 	catch(ParseException & e)
 	{
@@ -142,20 +133,12 @@ GameSave::GameSave(char * data, int dataSize)
 		dealloc();	//Free any allocated memory
 		throw;
 	}
-	//Collapse();
 }
 
 // Called on every new GameSave, including the copy constructor
 void GameSave::InitData()
 {
-	blockMap = NULL;
-	fanVelX = NULL;
-	fanVelY = NULL;
 	particles = NULL;
-	pressure = NULL;
-	velocityX = NULL;
-	velocityY = NULL;
-	ambientHeat = NULL;
 	fromNewerVersion = false;
 	hasPressure = false;
 	hasAmbientHeat = false;
@@ -215,7 +198,7 @@ void GameSave::read(char * data, int dataSize)
 		}
 		else if(data[0] == 'O' && data[1] == 'P' && data[2] == 'S')
 		{
-			if (data[3] != '1')
+			if (data[3] != OPS_BZIP2 && data[3] != OPS_LZ)
 				throw ParseException(ParseException::WrongVersion, "Save format from newer version");
 			readOPS(data, dataSize);
 		}
@@ -231,18 +214,6 @@ void GameSave::read(char * data, int dataSize)
 	}
 }
 
-template <typename T>
-T ** GameSave::Allocate2DArray(int blockWidth, int blockHeight, T defaultVal)
-{
-	T ** temp = new T*[blockHeight];
-	for (int y = 0; y < blockHeight; y++)
-	{
-		temp[y] = new T[blockWidth];
-		std::fill(&temp[y][0], &temp[y][0]+blockWidth, defaultVal);
-	}
-	return temp;
-}
-
 void GameSave::setSize(int newWidth, int newHeight)
 {
 	this->blockWidth = newWidth;
@@ -251,19 +222,19 @@ void GameSave::setSize(int newWidth, int newHeight)
 	particlesCount = 0;
 	particles = new Particle[NPART];
 
-	blockMap = Allocate2DArray<unsigned char>(blockWidth, blockHeight, 0);
-	fanVelX = Allocate2DArray<float>(blockWidth, blockHeight, 0.0f);
-	fanVelY = Allocate2DArray<float>(blockWidth, blockHeight, 0.0f);
-	pressure = Allocate2DArray<float>(blockWidth, blockHeight, 0.0f);
-	velocityX = Allocate2DArray<float>(blockWidth, blockHeight, 0.0f);
-	velocityY = Allocate2DArray<float>(blockWidth, blockHeight, 0.0f);
-	ambientHeat = Allocate2DArray<float>(blockWidth, blockHeight, 0.0f);
+	blockMap.Resize(blockWidth, blockHeight, 0);
+	fanVelX.Resize(blockWidth, blockHeight, 0.0f);
+	fanVelY.Resize(blockWidth, blockHeight, 0.0f);
+	pressure.Resize(blockWidth, blockHeight, 0.0f);
+	velocityX.Resize(blockWidth, blockHeight, 0.0f);
+	velocityY.Resize(blockWidth, blockHeight, 0.0f);
+	ambientHeat.Resize(blockWidth, blockHeight, 0.0f);
 }
 
-std::vector<char> GameSave::Serialise()
+std::vector<char> GameSave::Serialise(bool fastCompression)
 {
 	unsigned int dataSize;
-	char * data = Serialise(dataSize);
+	char * data = Serialise(dataSize, fastCompression);
 	if (data == NULL)
 		return std::vector<char>();
 	std::vector<char> dataVect(data, data+dataSize);
@@ -271,11 +242,11 @@ std::vector<char> GameSave::Serialise()
 	return dataVect;
 }
 
-char * GameSave::Serialise(unsigned int & dataSize)
+char * GameSave::Serialise(unsigned int & dataSize, bool fastCompression)
 {
 	try
 	{
-		return serialiseOPS(dataSize);
+		return serialiseOPS(dataSize, fastCompression);
 	}
 	catch (BuildException & e)
 	{
@@ -400,16 +371,16 @@ void GameSave::Transform(matrix2d transform, vector2d translate, vector2d transl
 	int x, y, nx, ny, newBlockWidth = newWidth / CELL, newBlockHeight = newHeight / CELL;
 	vector2d pos, vel;
 
-	unsigned char ** blockMapNew;
-	float **fanVelXNew, **fanVelYNew, **pressureNew, **velocityXNew, **velocityYNew, **ambientHeatNew;
+	BlockGrid<unsigned char> blockMapNew;
+	BlockGrid<float> fanVelXNew, fanVelYNew, pressureNew, velocityXNew, velocityYNew, ambientHeatNew;
 
-	blockMapNew = Allocate2DArray<unsigned char>(newBlockWidth, newBlockHeight, 0);
-	fanVelXNew = Allocate2DArray<float>(newBlockWidth, newBlockHeight, 0.0f);
-	fanVelYNew = Allocate2DArray<float>(newBlockWidth, newBlockHeight, 0.0f);
-	pressureNew = Allocate2DArray<float>(newBlockWidth, newBlockHeight, 0.0f);
-	velocityXNew = Allocate2DArray<float>(newBlockWidth, newBlockHeight, 0.0f);
-	velocityYNew = Allocate2DArray<float>(newBlockWidth, newBlockHeight, 0.0f);
-	ambientHeatNew = Allocate2DArray<float>(newBlockWidth, newBlockHeight, 0.0f);
+	blockMapNew.Resize(newBlockWidth, newBlockHeight, 0);
+	fanVelXNew.Resize(newBlockWidth, newBlockHeight, 0.0f);
+	fanVelYNew.Resize(newBlockWidth, newBlockHeight, 0.0f);
+	pressureNew.Resize(newBlockWidth, newBlockHeight, 0.0f);
+	velocityXNew.Resize(newBlockWidth, newBlockHeight, 0.0f);
+	velocityYNew.Resize(newBlockWidth, newBlockHeight, 0.0f);
+	ambientHeatNew.Resize(newBlockWidth, newBlockHeight, 0.0f);
 
 
 	// * Patch pipes if the transform is (looks close enough to) a 90-degree counter-clockwise rotation.
@@ -497,35 +468,16 @@ void GameSave::Transform(matrix2d transform, vector2d translate, vector2d transl
 		}
 	translated = v2d_add(m2d_multiply_v2d(transform, translated), translateReal);
 
-	for (int j = 0; j < blockHeight; j++)
-	{
-		delete[] blockMap[j];
-		delete[] fanVelX[j];
-		delete[] fanVelY[j];
-		delete[] pressure[j];
-		delete[] velocityX[j];
-		delete[] velocityY[j];
-		delete[] ambientHeat[j];
-	}
-
 	blockWidth = newBlockWidth;
 	blockHeight = newBlockHeight;
 
-	delete[] blockMap;
-	delete[] fanVelX;
-	delete[] fanVelY;
-	delete[] pressure;
-	delete[] velocityX;
-	delete[] velocityY;
-	delete[] ambientHeat;
-
-	blockMap = blockMapNew;
-	fanVelX = fanVelXNew;
-	fanVelY = fanVelYNew;
-	pressure = pressureNew;
-	velocityX = velocityXNew;
-	velocityY = velocityYNew;
-	ambientHeat = ambientHeatNew;
+	blockMap = std::move(blockMapNew);
+	fanVelX = std::move(fanVelXNew);
+	fanVelY = std::move(fanVelYNew);
+	pressure = std::move(pressureNew);
+	velocityX = std::move(velocityXNew);
+	velocityY = std::move(velocityYNew);
+	ambientHeat = std::move(ambientHeatNew);
 }
 
 void GameSave::CheckBsonFieldUser(bson_iterator iter, const char *field, unsigned char **data, unsigned int *fieldLen)
@@ -655,10 +607,18 @@ void GameSave::readOPS(char * data, int dataLength)
 	//(bson_iterator_key returns a pointer into bsonData, which is then used with strcmp)
 	bsonData[bsonDataLen] = 0;
 
-	int bz2ret;
-	if ((bz2ret = BZ2_bzBuffToBuffDecompress((char*)bsonData, &bsonDataLen, (char*)(inputData+12), inputDataLen-12, 0, 0)) != BZ_OK)
+	if (inputData[3] == OPS_LZ)
 	{
-		throw ParseException(ParseException::Corrupt, String::Build("Unable to decompress (ret ", bz2ret, ")"));
+		if (!LZDecompress((char*)bsonData, bsonDataLen, (char*)(inputData+12), inputDataLen-12))
+			throw ParseException(ParseException::Corrupt, "Unable to decompress");
+	}
+	else
+	{
+		int bz2ret;
+		if ((bz2ret = BZ2_bzBuffToBuffDecompress((char*)bsonData, &bsonDataLen, (char*)(inputData+12), inputDataLen-12, 0, 0)) != BZ_OK)
+		{
+			throw ParseException(ParseException::Corrupt, String::Build("Unable to decompress (ret ", bz2ret, ")"));
+		}
 	}
 
 	set_bson_err_handler([](const char* err) { throw ParseException(ParseException::Corrupt, "BSON error when parsing save: " + ByteString(err).FromUtf8()); });
@@ -950,17 +910,16 @@ void GameSave::readOPS(char * data, int dataLength)
 	//Read pressure data
 	if (pressData)
 	{
-		unsigned int j = 0;
-		unsigned char i, i2;
 		if (blockW * blockH > pressDataLen)
 			throw ParseException(ParseException::Corrupt, "Not enough pressure data");
-		for (unsigned int x = 0; x < blockW; x++)
+		// stored column by column, but filled in row by row
+		for (unsigned int y = 0; y < blockH; y++)
 		{
-			for (unsigned int y = 0; y < blockH; y++)
+			float *row = pressure[blockY+y] + blockX;
+			for (unsigned int x = 0; x < blockW; x++)
 			{
-				i = pressData[j++];
-				i2 = pressData[j++];
-				pressure[blockY+y][blockX+x] = ((i+(i2<<8))/128.0f)-256;
+				unsigned int j = (x*blockH+y)*2;
+				row[x] = ((pressData[j]+(pressData[j+1]<<8))/128.0f)-256;
 			}
 		}
 		hasPressure = true;
@@ -969,17 +928,16 @@ void GameSave::readOPS(char * data, int dataLength)
 	//Read vx data
 	if (vxData)
 	{
-		unsigned int j = 0;
-		unsigned char i, i2;
 		if (blockW * blockH > vxDataLen)
 			throw ParseException(ParseException::Corrupt, "Not enough vx data");
-		for (unsigned int x = 0; x < blockW; x++)
+		// stored column by column, but filled in row by row
+		for (unsigned int y = 0; y < blockH; y++)
 		{
-			for (unsigned int y = 0; y < blockH; y++)
+			float *row = velocityX[blockY+y] + blockX;
+			for (unsigned int x = 0; x < blockW; x++)
 			{
-				i = vxData[j++];
-				i2 = vxData[j++];
-				velocityX[blockY+y][blockX+x] = ((i+(i2<<8))/128.0f)-256;
+				unsigned int j = (x*blockH+y)*2;
+				row[x] = ((vxData[j]+(vxData[j+1]<<8))/128.0f)-256;
 			}
 		}
 	}
@@ -987,17 +945,16 @@ void GameSave::readOPS(char * data, int dataLength)
 	//Read vy data
 	if (vyData)
 	{
-		unsigned int j = 0;
-		unsigned char i, i2;
 		if (blockW * blockH > vyDataLen)
 			throw ParseException(ParseException::Corrupt, "Not enough vy data");
-		for (unsigned int x = 0; x < blockW; x++)
+		// stored column by column, but filled in row by row
+		for (unsigned int y = 0; y < blockH; y++)
 		{
-			for (unsigned int y = 0; y < blockH; y++)
+			float *row = velocityY[blockY+y] + blockX;
+			for (unsigned int x = 0; x < blockW; x++)
 			{
-				i = vyData[j++];
-				i2 = vyData[j++];
-				velocityY[blockY+y][blockX+x] = ((i+(i2<<8))/128.0f)-256;
+				unsigned int j = (x*blockH+y)*2;
+				row[x] = ((vyData[j]+(vyData[j+1]<<8))/128.0f)-256;
 			}
 		}
 	}
@@ -1005,16 +962,17 @@ void GameSave::readOPS(char * data, int dataLength)
 	//Read ambient data
 	if (ambientData)
 	{
-		unsigned int i = 0, tempTemp;
 		if (blockW * blockH > ambientDataLen)
 			throw ParseException(ParseException::Corrupt, "Not enough ambient heat data");
-		for (unsigned int x = 0; x < blockW; x++)
+		for (unsigned int y = 0; y < blockH; y++)
 		{
-			for (unsigned int y = 0; y < blockH; y++)
+			float *row = ambientHeat[blockY+y] + blockX;
+			for (unsigned int x = 0; x < blockW; x++)
 			{
-				tempTemp = ambientData[i++];
-				tempTemp |= (((unsigned)ambientData[i++]) << 8);
-				ambientHeat[blockY+y][blockX+x] = float(tempTemp);
+				unsigned int i = (x*blockH+y)*2;
+				unsigned int tempTemp = ambientData[i];
+				tempTemp |= (((unsigned)ambientData[i+1]) << 8);
+				row[x] = float(tempTemp);
 			}
 		}
 		hasAmbientHeat = true;
@@ -2053,7 +2011,7 @@ void GameSave::readPSv(char * saveDataChar, int dataLength)
 	minimumMinorVersion = minor;\
 }
 
-char * GameSave::serialiseOPS(unsigned int & dataLength)
+char * GameSave::serialiseOPS(unsigned int & dataLength, bool fastCompression)
 {
 	int blockX, blockY, blockW, blockH, fullX, fullY, fullW, fullH;
 	int x, y, i;
@@ -2089,37 +2047,55 @@ char * GameSave::serialiseOPS(unsigned int & dataLength)
 		throw BuildException("Save error, out of memory (blockmaps)");
 	unsigned int wallDataLen = blockWidth*blockHeight, fanDataLen = 0, pressDataLen = 0, vxDataLen = 0, vyDataLen = 0, ambientDataLen = 0;
 
-	for (x = blockX; x < blockX+blockW; x++)
+	// the grids are walked row by row; pressure, velocity and ambient heat are
+	// stored column by column, so each cell's position in them is worked out
+	for (y = blockY; y < blockY+blockH; y++)
 	{
-		for (y = blockY; y < blockY+blockH; y++)
+		for (x = blockX; x < blockX+blockW; x++)
 		{
 			wallData[(y-blockY)*blockW+(x-blockX)] = blockMap[y][x];
 			if (blockMap[y][x])
 				hasWallData = true;
+			if (blockMap[y][x] == WL_STASIS)
+			{
+				RESTRICTVERSION(94, 0);
+			}
 
+			unsigned int j = ((x-blockX)*blockH+(y-blockY))*2;
 			if (hasPressure)
 			{
 				//save pressure and x/y velocity grids
 				float pres = std::max(-255.0f,std::min(255.0f,pressure[y][x]))+256.0f;
 				float velX = std::max(-255.0f,std::min(255.0f,velocityX[y][x]))+256.0f;
 				float velY = std::max(-255.0f,std::min(255.0f,velocityY[y][x]))+256.0f;
-				pressData[pressDataLen++] = (unsigned char)((int)(pres*128)&0xFF);
-				pressData[pressDataLen++] = (unsigned char)((int)(pres*128)>>8);
+				pressData[j] = (unsigned char)((int)(pres*128)&0xFF);
+				pressData[j+1] = (unsigned char)((int)(pres*128)>>8);
 
-				vxData[vxDataLen++] = (unsigned char)((int)(velX*128)&0xFF);
-				vxData[vxDataLen++] = (unsigned char)((int)(velX*128)>>8);
+				vxData[j] = (unsigned char)((int)(velX*128)&0xFF);
+				vxData[j+1] = (unsigned char)((int)(velX*128)>>8);
 
-				vyData[vyDataLen++] = (unsigned char)((int)(velY*128)&0xFF);
-				vyData[vyDataLen++] = (unsigned char)((int)(velY*128)>>8);
+				vyData[j] = (unsigned char)((int)(velY*128)&0xFF);
+				vyData[j+1] = (unsigned char)((int)(velY*128)>>8);
 			}
 
 			if (hasAmbientHeat)
 			{
 				int tempTemp = (int)(ambientHeat[y][x]+0.5f);
-				ambientData[ambientDataLen++] = tempTemp;
-				ambientData[ambientDataLen++] = tempTemp >> 8;
+				ambientData[j] = tempTemp;
+				ambientData[j+1] = tempTemp >> 8;
 			}
+		}
+	}
+	if (hasPressure)
+		pressDataLen = vxDataLen = vyDataLen = blockW*blockH*2;
+	if (hasAmbientHeat)
+		ambientDataLen = blockW*blockH*2;
 
+	// fan data only has entries for fans, in column order
+	for (x = blockX; x < blockX+blockW; x++)
+	{
+		for (y = blockY; y < blockY+blockH; y++)
+		{
 			if (blockMap[y][x] == WL_FAN)
 			{
 				i = (int)(fanVelX[y][x]*64.0f+127.5f);
@@ -2131,10 +2107,6 @@ char * GameSave::serialiseOPS(unsigned int & dataLength)
 				if (i>255) i=255;
 				fanData[fanDataLen++] = i;
 			}
-			else if (blockMap[y][x] == WL_STASIS)
-			{
-				RESTRICTVERSION(94, 0);
-			}
 		}
 	}
 
@@ -2662,14 +2634,17 @@ char * GameSave::serialiseOPS(unsigned int & dataLength)
 
 	unsigned char *finalData = (unsigned char*)bson_data(&b);
 	unsigned int finalDataLen = bson_size(&b);
-	auto outputData = std::unique_ptr<unsigned char[]>(new unsigned char[finalDataLen*2+12]);
+	unsigned int maxCompressedSize = finalDataLen*2;
+	if (fastCompression)
+		maxCompressedSize = std::max(maxCompressedSize, (unsigned int)LZCompressBound(finalDataLen));
+	auto outputData = std::unique_ptr<unsigned char[]>(new unsigned char[maxCompressedSize+12]);
 	if (!outputData)
-		throw BuildException(String::Build("Save error, out of memory (finalData): ", finalDataLen*2+12));
+		throw BuildException(String::Build("Save error, out of memory (finalData): ", maxCompressedSize+12));
 
 	outputData[0] = 'O';
 	outputData[1] = 'P';
 	outputData[2] = 'S';
-	outputData[3] = '1';
+	outputData[3] = fastCompression ? OPS_LZ : OPS_BZIP2;
 	outputData[4] = SAVE_VERSION;
 	outputData[5] = CELL;
 	outputData[6] = blockW;
@@ -2679,8 +2654,10 @@ char * GameSave::serialiseOPS(unsigned int & dataLength)
 	outputData[10] = finalDataLen >> 16;
 	outputData[11] = finalDataLen >> 24;
 
-	unsigned int compressedSize = finalDataLen*2, bz2ret;
-	if ((bz2ret = BZ2_bzBuffToBuffCompress((char*)(outputData.get()+12), &compressedSize, (char*)finalData, bson_size(&b), 9, 0, 0)) != BZ_OK)
+	unsigned int compressedSize = maxCompressedSize, bz2ret;
+	if (fastCompression)
+		compressedSize = LZCompress((char*)(outputData.get()+12), (char*)finalData, finalDataLen);
+	else if ((bz2ret = BZ2_bzBuffToBuffCompress((char*)(outputData.get()+12), &compressedSize, (char*)finalData, bson_size(&b), 9, 0, 0)) != BZ_OK)
 	{
 		throw BuildException(String::Build("Save error, could not compress (ret ", bz2ret, ")"));
 	}
@@ -2817,19 +2794,6 @@ void GameSave::ConvertJsonToBson(bson *b, Json::Value j, int depth)
 	}
 }
 
-// deallocates a pointer to a 2D array and sets it to NULL
-template <typename T>
-void GameSave::Deallocate2DArray(T ***array, int blockHeight)
-{
-	if (*array)
-	{
-		for (int y = 0; y < blockHeight; y++)
-			delete[] (*array)[y];
-		delete[] (*array);
-		*array = NULL;
-	}
-}
-
 bool GameSave::TypeInCtype(int type, int ctype)
 {
 	return ctype >= 0 && ctype < PT_NUM &&
@@ -2857,13 +2821,13 @@ void GameSave::dealloc()
 		delete[] particles;
 		particles = NULL;
 	}
-	Deallocate2DArray<unsigned char>(&blockMap, blockHeight);
-	Deallocate2DArray<float>(&fanVelX, blockHeight);
-	Deallocate2DArray<float>(&fanVelY, blockHeight);
-	Deallocate2DArray<float>(&pressure, blockHeight);
-	Deallocate2DArray<float>(&velocityX, blockHeight);
-	Deallocate2DArray<float>(&velocityY, blockHeight);
-	Deallocate2DArray<float>(&ambientHeat, blockHeight);
+	blockMap.Clear();
+	fanVelX.Clear();
+	fanVelY.Clear();
+	pressure.Clear();
+	velocityX.Clear();
+	velocityY.Clear();
+	ambientHeat.Clear();
 }
 
 GameSave::~GameSave()
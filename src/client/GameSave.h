@@ -66,6 +66,35 @@ public:
 	}
 };
 
+// A grid of per-block values, stored row by row in one allocation. It is
+// indexed like a 2D array, grid[y][x].
+template<class T>
+class BlockGrid
+{
+	int width;
+	std::vector<T> data;
+
+public:
+	BlockGrid():
+		width(0)
+	{
+	}
+
+	void Resize(int newWidth, int newHeight, T value)
+	{
+		width = newWidth;
+		data.assign(size_t(newWidth) * newHeight, value);
+	}
+	void Clear()
+	{
+		width = 0;
+		std::vector<T>().swap(data);
+	}
+
+	T *operator [](int y) { return data.data() + size_t(y) * width; }
+	const T *operator [](int y) const { return data.data() + size_t(y) * width; }
+};
+
 class GameSave
 {
 public:
@@ -80,13 +109,13 @@ public:
 	//int ** particleMap;
 	int particlesCount;
 	Particle * particles;
-	unsigned char ** blockMap;
-	float ** fanVelX;
-	float ** fanVelY;
-	float ** pressure;
-	float ** velocityX;
-	float ** velocityY;
-	float ** ambientHeat;
+	BlockGrid<unsigned char> blockMap;
+	BlockGrid<float> fanVelX;
+	BlockGrid<float> fanVelY;
+	BlockGrid<float> pressure;
+	BlockGrid<float> velocityX;
+	BlockGrid<float> velocityY;
+	BlockGrid<float> ambientHeat;
 
 	//Simulation Options
 	bool waterEEnabled;
@@ -115,13 +144,20 @@ public:
 	GameSave();
 	GameSave(GameSave & save);
 	GameSave(int width, int height);
+	// parses data borrowed from the caller without keeping a copy of it, so
+	// the save stays expanded; for saves loaded into the simulation right
+	// away, whose file data is not needed afterwards
 	GameSave(char * data, int dataSize);
-	GameSave(std::vector<char> data);
-	GameSave(std::vector<unsigned char> data);
+	// the save is parsed straight away to check it, then collapsed again
+	// unless it is about to be loaded anyway, which would parse it again
+	GameSave(std::vector<char> data, bool collapse = true);
+	GameSave(const std::vector<unsigned char> &data, bool collapse = true);
 	~GameSave();
 	void setSize(int width, int height);
-	char * Serialise(unsigned int & dataSize);
-	std::vector<char> Serialise();
+	// fastCompression uses a much faster codec than bzip2 that only this
+	// version can read, so it is only for files that stay on this machine
+	char * Serialise(unsigned int & dataSize, bool fastCompression = false);
+	std::vector<char> Serialise(bool fastCompression = false);
 	vector2d Translate(vector2d translate);
 	void Transform(matrix2d transform, vector2d translate);
 	void Transform(matrix2d transform, vector2d translate, vector2d translateReal, int newWidth, int newHeight);
@@ -147,17 +183,16 @@ private:
 
 	void InitData();
 	void InitVars();
+	void InitFromOriginalData(bool collapse);
 	void CheckBsonFieldUser(bson_iterator iter, const char *field, unsigned char **data, unsigned int *fieldLen);
 	void CheckBsonFieldBool(bson_iterator iter, const char *field, bool *flag);
 	void CheckBsonFieldInt(bson_iterator iter, const char *field, int *setting);
 	void CheckBsonFieldFloat(bson_iterator iter, const char *field, float *setting);
-	template <typename T> T ** Allocate2DArray(int blockWidth, int blockHeight, T defaultVal);
-	template <typename T> void Deallocate2DArray(T ***array, int blockHeight);
 	void dealloc();
 	void read(char * data, int dataSize);
 	void readOPS(char * data, int dataLength);
 	void readPSv(char * data, int dataLength);
-	char * serialiseOPS(unsigned int & dataSize);
+	char * serialiseOPS(unsigned int & dataSize, bool fastCompression);
 	void ConvertJsonToBson(bson *b, Json::Value j, int depth = 0);
 	void ConvertBsonToJson(bson_iterator *b, Json::Value *j, int depth = 0);
 };
@@ -0,0 +1,76 @@
+#include "ThumbnailCache.h"
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "Format.h"
+#include "MD5.h"
+#include "common/Platform.h"
+#include "graphics/Graphics.h"
+
+// bump this whenever thumbnails would come out differently, e.g. when the
+// render modes SaveRenderer uses change, so that old entries are not used
+#define THUMBNAILCACHE_VERSION 1
+
+namespace ThumbnailCache
+{
+	static ByteString filenameHash(ByteString filename)
+	{
+		char hash[33];
+		md5_ascii(hash, reinterpret_cast<const unsigned char *>(filename.c_str()), filename.size());
+		return hash;
+	}
+
+	static ByteString cacheFilename(ByteString filename, ByteString variant)
+	{
+		return ByteString::Build(THUMBNAIL_CACHE_DIR, PATH_SEP, filenameHash(filename), "_", variant, ".pti");
+	}
+
+	// identifies the version of the file a thumbnail was rendered from
+	static bool fileStamp(ByteString filename, ByteString &stamp)
+	{
+		time_t modifiedTime;
+		long long size;
+		if (!Platform::FileInfo(filename, modifiedTime, size))
+			return false;
+		stamp = ByteString::Build(THUMBNAILCACHE_VERSION, " ", (long long)modifiedTime, " ", size, " ", filename, "\n");
+		return true;
+	}
+
+	std::unique_ptr<VideoBuffer> Load(ByteString filename, ByteString variant)
+	{
+		ByteString stamp;
+		if (!fileStamp(filename, stamp))
+			return nullptr;
+		std::ifstream cacheFile(cacheFilename(filename, variant).c_str(), std::ios::binary);
+		if (!cacheFile.is_open())
+			return nullptr;
+		std::vector<char> data((std::istreambuf_iterator<char>(cacheFile)), std::istreambuf_iterator<char>());
+		if (data.size() <= stamp.size() || !std::equal(stamp.begin(), stamp.end(), data.begin()))
+			return nullptr;
+		std::vector<char> ptiData(data.begin() + stamp.size(), data.end());
+		return std::unique_ptr<VideoBuffer>(format::PTIToVideoBuffer(ptiData));
+	}
+
+	void Store(ByteString filename, ByteString variant, const VideoBuffer &thumbnail)
+	{
+		ByteString stamp;
+		if (!fileStamp(filename, stamp))
+			return;
+		std::vector<char> ptiData = format::VideoBufferToPTI(thumbnail);
+		if (!ptiData.size())
+			return;
+		Platform::MakeDirectory(THUMBNAIL_CACHE_DIR);
+		std::ofstream cacheFile(cacheFilename(filename, variant).c_str(), std::ios::binary);
+		cacheFile.write(stamp.c_str(), stamp.size());
+		cacheFile.write(&ptiData[0], ptiData.size());
+	}
+
+	void Invalidate(ByteString filename)
+	{
+		ByteString hash = filenameHash(filename);
+		for (auto &entry : Platform::DirectorySearch(THUMBNAIL_CACHE_DIR, hash, { ".pti" }))
+			Platform::DeleteFile(ByteString::Build(THUMBNAIL_CACHE_DIR, PATH_SEP, entry));
+	}
+}
@@ -0,0 +1,24 @@
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+#include "Config.h"
+
+#include <memory>
+
+#include "common/String.h"
+
+class VideoBuffer;
+
+// Rendered thumbnails of local saves and stamps, kept on disk so browsers
+// don't have to render every file again each time they are opened. An entry
+// belongs to a file path and a variant (the size and options it was rendered
+// with), and is only used while the file's modification time and size still
+// match the ones it was stored with.
+namespace ThumbnailCache
+{
+	std::unique_ptr<VideoBuffer> Load(ByteString filename, ByteString variant);
+	void Store(ByteString filename, ByteString variant, const VideoBuffer &thumbnail);
+	// removes every variant of the file's thumbnail
+	void Invalidate(ByteString filename);
+}
+
+#endif // THUMBNAILCACHE_H
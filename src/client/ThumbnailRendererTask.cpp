@@ -5,6 +5,7 @@
 #include "graphics/Graphics.h"
 #include "simulation/SaveRenderer.h"
 #include "client/GameSave.h"
+#include "client/ThumbnailCache.h"
 
 ThumbnailRendererTask::ThumbnailRendererTask(GameSave *save, int width, int height, bool autoRescale, bool decorations, bool fire) :
 	Save(new GameSave(*save)),
@@ -20,8 +21,26 @@ ThumbnailRendererTask::~ThumbnailRendererTask()
 {
 }
 
+ByteString ThumbnailRendererTask::cacheVariant()
+{
+	return ByteString::Build(Width, "x", Height, AutoRescale ? "a" : "", Decorations ? "d" : "", Fire ? "f" : "");
+}
+
 bool ThumbnailRendererTask::doWork()
 {
+	ByteString variant;
+	if (cacheFilename.size())
+	{
+		variant = cacheVariant();
+		thumbnail = ThumbnailCache::Load(cacheFilename, variant);
+		if (thumbnail)
+		{
+			Width = thumbnail->Width;
+			Height = thumbnail->Height;
+			return true;
+		}
+	}
+
 	thumbnail = std::unique_ptr<VideoBuffer>(SaveRenderer::Ref().Render(Save.get(), Decorations, Fire));
 	if (thumbnail)
 	{
@@ -39,6 +58,8 @@ bool ThumbnailRendererTask::doWork()
 		{
 			thumbnail->Resize(Width, Height, true);
 		}
+		if (cacheFilename.size())
+			ThumbnailCache::Store(cacheFilename, variant, *thumbnail);
 		return true;
 	}
 	else
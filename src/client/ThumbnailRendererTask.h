@@ -5,6 +5,8 @@
 
 #include <memory>
 
+#include "common/String.h"
+
 class GameSave;
 class VideoBuffer;
 class ThumbnailRendererTask : public AbandonableTask
@@ -15,11 +17,18 @@ class ThumbnailRendererTask : public AbandonableTask
 	bool Fire;
 	bool AutoRescale;
 	std::unique_ptr<VideoBuffer> thumbnail;
+	ByteString cacheFilename;
+
+	ByteString cacheVariant();
 
 public:
 	ThumbnailRendererTask(GameSave *save, int width, int height, bool autoRescale = false, bool decorations = true, bool fire = true);
 	virtual ~ThumbnailRendererTask();
 
+	// the file the save was read from; its thumbnail is then looked up in and
+	// stored to the thumbnail cache
+	void SetCacheFile(ByteString filename) { cacheFilename = filename; }
+
 	virtual bool doWork() override;
 	std::unique_ptr<VideoBuffer> Finish();
 };
@@ -234,6 +234,21 @@ bool FileExists(ByteString filename)
 	}
 }
 
+bool FileInfo(ByteString filename, time_t &modifiedTime, long long &size)
+{
+#ifdef WIN
+	struct _stat s;
+	if (_stat(filename.c_str(), &s) != 0)
+#else
+	struct stat s;
+	if (stat(filename.c_str(), &s) != 0)
+#endif
+		return false;
+	modifiedTime = s.st_mtime;
+	size = s.st_size;
+	return true;
+}
+
 bool DirectoryExists(ByteString directory)
 {
 #ifdef WIN
@@ -3,6 +3,7 @@
 #include "Config.h"
 
 #include "common/String.h"
+#include <ctime>
 
 #ifdef WIN
 # include <string>
@@ -23,6 +24,10 @@ namespace Platform
 
 	bool Stat(ByteString filename);
 	bool FileExists(ByteString filename);
+	/**
+	 * @return true on success
+	 */
+	bool FileInfo(ByteString filename, time_t &modifiedTime, long long &size);
 	bool DirectoryExists(ByteString directory);
 	/**
 	 * @return true on success
@@ -0,0 +1,100 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstdint>
+
+ThreadPool::ThreadPool(int threads)
+{
+	SetThreads(threads);
+}
+
+ThreadPool::~ThreadPool()
+{
+	stop();
+}
+
+void ThreadPool::stop()
+{
+	{
+		std::lock_guard<std::mutex> l(mutex);
+		stopping = true;
+	}
+	startCv.notify_all();
+	for (auto &thread : workers)
+		thread.join();
+	workers.clear();
+	stopping = false;
+}
+
+void ThreadPool::SetThreads(int threads)
+{
+	threads = std::max(threads, 1);
+	if (threads == GetThreads())
+		return;
+	stop();
+	unsigned int startGeneration = generation;
+	for (int i = 1; i < threads; i++)
+		workers.push_back(std::thread([this, i, startGeneration]() { worker(i, startGeneration); }));
+}
+
+int ThreadPool::HardwareThreads()
+{
+	return std::max(int(std::thread::hardware_concurrency()), 1);
+}
+
+void ThreadPool::band(int band, int &begin, int &end)
+{
+	int threads = GetThreads();
+	begin = int(int64_t(jobCount) * band / threads);
+	end = int(int64_t(jobCount) * (band + 1) / threads);
+}
+
+void ThreadPool::worker(int bandIndex, unsigned int seenGeneration)
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> l(mutex);
+			startCv.wait(l, [this, seenGeneration]() { return stopping || generation != seenGeneration; });
+			if (stopping)
+				return;
+			seenGeneration = generation;
+		}
+		int begin, end;
+		band(bandIndex, begin, end);
+		if (begin < end)
+			job(begin, end);
+		bool last;
+		{
+			std::lock_guard<std::mutex> l(mutex);
+			last = !--pending;
+		}
+		if (last)
+			doneCv.notify_one();
+	}
+}
+
+void ThreadPool::ParallelFor(int count, std::function<void (int, int)> func)
+{
+	if (workers.empty())
+	{
+		if (count > 0)
+			func(0, count);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> l(mutex);
+		job = std::move(func);
+		jobCount = count;
+		pending = int(workers.size());
+		generation++;
+	}
+	startCv.notify_all();
+	int begin, end;
+	band(0, begin, end);
+	if (begin < end)
+		job(begin, end);
+	std::unique_lock<std::mutex> l(mutex);
+	doneCv.wait(l, [this]() { return !pending; });
+	job = nullptr;
+}
@@ -0,0 +1,44 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#include "Config.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Splits a range of rows (or anything else) into contiguous bands and runs
+// them on a fixed set of worker threads. The calling thread always takes the
+// first band, so a pool with a single thread has no workers and runs inline.
+class ThreadPool
+{
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable startCv;
+	std::condition_variable doneCv;
+	std::function<void (int, int)> job;
+	int jobCount = 0;
+	unsigned int generation = 0;
+	int pending = 0;
+	bool stopping = false;
+
+	void worker(int band, unsigned int seenGeneration);
+	void band(int band, int &begin, int &end);
+	void stop();
+
+public:
+	ThreadPool(int threads = 1);
+	~ThreadPool();
+
+	// Number of threads including the calling one, changing it restarts the workers
+	void SetThreads(int threads);
+	int GetThreads() const { return int(workers.size()) + 1; }
+
+	// Calls func(begin, end) for bands covering [0, count) and returns once all are done
+	void ParallelFor(int count, std::function<void (int, int)> func);
+
+	static int HardwareThreads();
+};
+
+#endif
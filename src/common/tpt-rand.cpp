@@ -62,4 +62,6 @@ void RNG::seed(unsigned int sd)
 	s[1] = sd;
 }
 
+thread_local RNG *RNG::threadInstance = nullptr;
+
 RNG random_gen;
@@ -10,7 +10,19 @@ class RNG : public Singleton<RNG>
 private:
 	uint64_t s[2];
 	uint64_t next();
+	static thread_local RNG *threadInstance;
 public:
+	// the generator for the calling thread, which is the shared one unless the
+	// thread has installed its own with SetThreadInstance
+	static RNG &Ref()
+	{
+		return threadInstance ? *threadInstance : Singleton<RNG>::Ref();
+	}
+	static void SetThreadInstance(RNG *rng)
+	{
+		threadInstance = rng;
+	}
+
 	unsigned int operator()();
 	unsigned int gen();
 	int between(int lower, int upper);
@@ -1,5 +1,7 @@
 #include "DebugParts.h"
 
+#include <algorithm>
+
 #include "gui/interface/Engine.h"
 
 #include "simulation/Simulation.h"
@@ -47,6 +49,21 @@ void DebugParts::Draw()
 	g->addpixel(lpx, lpy+1, 255, 50, 50, 120);
 	g->addpixel(lpx, lpy-1, 255, 50, 50, 120);
 
+	// tint chunks whose particles aren't being updated
+	if (sim->chunk_sleep)
+	{
+		int sleeping = 0;
+		for (int cy = 0; cy < SLEEPCHUNKS_Y; cy++)
+			for (int cx = 0; cx < SLEEPCHUNKS_X; cx++)
+				if (sim->ChunkAsleep(cx, cy))
+				{
+					int w = std::min(SLEEPCHUNK, XRES - cx*SLEEPCHUNK), h = std::min(SLEEPCHUNK, YRES - cy*SLEEPCHUNK);
+					g->fillrect(cx*SLEEPCHUNK, cy*SLEEPCHUNK, w, h, 0, 100, 255, 70);
+					sleeping++;
+				}
+		info += String::Build(", ", sleeping, "/", SLEEPCHUNKS_X*SLEEPCHUNKS_Y, " chunks asleep");
+	}
+
 	g->fillrect(7, YRES-26, g->textwidth(info)+5, 14, 0, 0, 0, 180);
 	g->drawtext(10, YRES-22, info, 255, 255, 255, 255);
 }
@@ -0,0 +1,88 @@
+#include "ElementTiming.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "gui/interface/Engine.h"
+
+#include "simulation/Simulation.h"
+
+#include "graphics/Graphics.h"
+
+ElementTimingDebug::ElementTimingDebug(unsigned int id, Simulation * sim):
+	DebugInfo(id),
+	sim(sim)
+{
+	std::fill(averageTime, averageTime + PT_NUM, 0.0f);
+	std::fill(averageLuaTime, averageLuaTime + PT_NUM, 0.0f);
+	std::fill(averageCalls, averageCalls + PT_NUM, 0.0f);
+}
+
+void ElementTimingDebug::Draw()
+{
+	Graphics * g = ui::Engine::Ref().g;
+	SimulationTimings &timings = sim->timings;
+
+	// only fold in frames where the simulation actually ran, so pausing keeps the last figures up
+	bool ran = false;
+	for (int i = 0; i < PT_NUM; i++)
+		if (timings.elementCalls[i])
+			ran = true;
+	if (ran)
+	{
+		for (int i = 0; i < PT_NUM; i++)
+		{
+			averageTime[i] = (averageTime[i]*(1.0f-0.05f)) + (0.05f*timings.elementNanoseconds[i]/1e6f);
+			averageLuaTime[i] = (averageLuaTime[i]*(1.0f-0.05f)) + (0.05f*timings.elementLuaNanoseconds[i]/1e6f);
+			averageCalls[i] = (averageCalls[i]*(1.0f-0.05f)) + (0.05f*timings.elementCalls[i]);
+		}
+	}
+	timings.ResetElements();
+
+	float total = 0;
+	std::vector<int> types;
+	for (int i = 0; i < PT_NUM; i++)
+	{
+		if (sim->elements[i].Enabled && averageTime[i] > 0.0005f)
+		{
+			total += averageTime[i];
+			types.push_back(i);
+		}
+	}
+	std::sort(types.begin(), types.end(), [this](int a, int b) {
+		return averageTime[a] > averageTime[b];
+	});
+	if (types.size() > 16)
+		types.resize(16);
+
+	int width = 270;
+	int xStart = XRES - width - 10;
+	int yStart = YRES - 10 - (int(types.size()) + 2) * 12;
+
+	g->fillrect(xStart - 5, yStart - 5, width + 10, (int(types.size()) + 2) * 12 + 8, 0, 0, 0, 180);
+	g->drawtext(xStart, yStart, String::Build("Element update: ", Format::Precision(total, 2), " ms/frame"), 255, 255, 255, 255);
+	yStart += 14;
+	g->drawtext(xStart + 60, yStart, "ms", 255, 255, 255, 180);
+	g->drawtext(xStart + 110, yStart, "share", 255, 255, 255, 180);
+	g->drawtext(xStart + 155, yStart, "ns/part", 255, 255, 255, 180);
+	g->drawtext(xStart + 215, yStart, "Lua", 255, 255, 255, 180);
+	yStart += 12;
+
+	for (auto type : types)
+	{
+		auto &element = sim->elements[type];
+		g->drawtext(xStart, yStart, element.Name, PIXR(element.Colour), PIXG(element.Colour), PIXB(element.Colour), 255);
+		g->drawtext(xStart + 60, yStart, String::Build(Format::Precision(averageTime[type], 2)), 255, 255, 255, 255);
+		g->drawtext(xStart + 110, yStart, String::Build(Format::Precision(total > 0 ? averageTime[type] / total * 100.0f : 0.0f, 1), "%"), 255, 255, 255, 255);
+		if (averageCalls[type] >= 1.0f)
+			g->drawtext(xStart + 155, yStart, String::Build(int(averageTime[type] * 1e6f / averageCalls[type])), 255, 255, 255, 255);
+		if (averageLuaTime[type] > 0.0005f)
+			g->drawtext(xStart + 215, yStart, String::Build(Format::Precision(averageLuaTime[type] / averageTime[type] * 100.0f, 0), "%"), 255, 220, 120, 255);
+		yStart += 12;
+	}
+}
+
+ElementTimingDebug::~ElementTimingDebug()
+{
+
+}
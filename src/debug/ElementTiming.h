@@ -0,0 +1,18 @@
+#pragma once
+
+#include "DebugInfo.h"
+
+#include "simulation/ElementDefs.h"
+
+class Simulation;
+class ElementTimingDebug : public DebugInfo
+{
+	Simulation * sim;
+	float averageTime[PT_NUM];
+	float averageLuaTime[PT_NUM];
+	float averageCalls[PT_NUM];
+public:
+	ElementTimingDebug(unsigned int id, Simulation * sim);
+	void Draw() override;
+	virtual ~ElementTimingDebug();
+};
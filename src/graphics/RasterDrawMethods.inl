@@ -1,6 +1,12 @@
 #include <cmath>
 #include "FontReader.h"
 
+// pixels are only drawn where this is false, the including file can define
+// it to draw to part of the buffer
+#ifndef PIXELMETHODS_CLIPPED
+#define PIXELMETHODS_CLIPPED(x, y) ((x)<0 || (y)<0 || (x)>=VIDXRES || (y)>=VIDYRES)
+#endif
+
 int PIXELMETHODS_CLASS::drawtext_outline(int x, int y, String s, int r, int g, int b, int a)
 {
 	drawtext(x-1, y-1, s, 0, 0, 0, 120);
@@ -104,7 +110,7 @@ int PIXELMETHODS_CLASS::addchar(int x, int y, String::value_type c, int r, int g
 TPT_INLINE void PIXELMETHODS_CLASS::xor_pixel(int x, int y)
 {
 	int c;
-	if (x<0 || y<0 || x>=XRES || y>=YRES)
+	if (x<0 || y<0 || x>=XRES || y>=YRES || PIXELMETHODS_CLIPPED(x, y))
 		return;
 	c = vid[y*(VIDXRES)+x];
 	c = PIXB(c) + 3*PIXG(c) + 2*PIXR(c);
@@ -117,7 +123,7 @@ TPT_INLINE void PIXELMETHODS_CLASS::xor_pixel(int x, int y)
 void PIXELMETHODS_CLASS::blendpixel(int x, int y, int r, int g, int b, int a)
 {
 	pixel t;
-	if (x<0 || y<0 || x>=VIDXRES || y>=VIDYRES)
+	if (PIXELMETHODS_CLIPPED(x, y))
 		return;
 	if (a!=255)
 	{
@@ -132,7 +138,7 @@ void PIXELMETHODS_CLASS::blendpixel(int x, int y, int r, int g, int b, int a)
 void PIXELMETHODS_CLASS::addpixel(int x, int y, int r, int g, int b, int a)
 {
 	pixel t;
-	if (x<0 || y<0 || x>=VIDXRES || y>=VIDYRES)
+	if (PIXELMETHODS_CLIPPED(x, y))
 		return;
 	t = vid[y*(VIDXRES)+x];
 	r = (a*r + 255*PIXR(t)) >> 8;
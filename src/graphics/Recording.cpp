@@ -0,0 +1,220 @@
+#include "Recording.h"
+
+#include <cstring>
+#include <zlib.h>
+
+// unchanged pixels shorter than this between two changed runs are written
+// as part of one run, since a run header costs about as much
+#define RECORDING_MERGE_GAP 3
+
+static void writeU32(std::vector<unsigned char> &data, uint32_t value)
+{
+	data.push_back(value & 0xFF);
+	data.push_back((value >> 8) & 0xFF);
+	data.push_back((value >> 16) & 0xFF);
+	data.push_back((value >> 24) & 0xFF);
+}
+
+static uint32_t readU32(const unsigned char *data)
+{
+	return uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+}
+
+RecordingWriter::RecordingWriter(ByteString filename, int width, int height, size_t maxQueued):
+	width(width),
+	height(height),
+	maxQueued(maxQueued),
+	failed(false),
+	framesWritten(0),
+	done(false)
+{
+	file.open(filename.c_str(), std::ios::binary);
+	std::vector<unsigned char> header(recording::magic, recording::magic + strlen(recording::magic));
+	writeU32(header, recording::version);
+	writeU32(header, width);
+	writeU32(header, height);
+	file.write(reinterpret_cast<const char *>(&header[0]), header.size());
+	failed = !file;
+	thread = std::thread([this]() { Run(); });
+}
+
+RecordingWriter::~RecordingWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		done = true;
+	}
+	frameAvailable.notify_one();
+	thread.join();
+}
+
+void RecordingWriter::AddFrame(std::vector<pixel> frame)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	spaceAvailable.wait(lock, [this]() { return queue.size() < maxQueued; });
+	queue.push_back(std::move(frame));
+	lock.unlock();
+	frameAvailable.notify_one();
+}
+
+bool RecordingWriter::Failed()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return failed;
+}
+
+int RecordingWriter::GetFramesWritten()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return framesWritten;
+}
+
+void RecordingWriter::Run()
+{
+	std::vector<pixel> frame;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			frameAvailable.wait(lock, [this]() { return done || queue.size(); });
+			if (!queue.size())
+				break;
+			frame = std::move(queue.front());
+			queue.pop_front();
+		}
+		spaceAvailable.notify_one();
+		WriteFrame(frame);
+	}
+}
+
+void RecordingWriter::WriteFrame(const std::vector<pixel> &frame)
+{
+	int size = width * height;
+	if ((int)frame.size() != size)
+		return;
+	// the first frame is compared against nothing, so it is written in full
+	bool first = !previous.size();
+	auto changed = [this, &frame, first](int i) {
+		return first || frame[i] != previous[i];
+	};
+
+	// each run is the number of unchanged pixels skipped since the last run,
+	// the number of pixels in the run, then the pixels
+	runs.clear();
+	int i = 0, lastEnd = 0;
+	while (i < size)
+	{
+		if (!changed(i))
+		{
+			i++;
+			continue;
+		}
+		int start = i, end = i + 1;
+		for (int j = end; j < size && j - end < RECORDING_MERGE_GAP; j++)
+			if (changed(j))
+				end = j + 1;
+		writeU32(runs, start - lastEnd);
+		writeU32(runs, end - start);
+		for (int j = start; j < end; j++)
+		{
+			runs.push_back(PIXR(frame[j]));
+			runs.push_back(PIXG(frame[j]));
+			runs.push_back(PIXB(frame[j]));
+		}
+		lastEnd = i = end;
+	}
+	previous = frame;
+
+	const unsigned char empty = 0;
+	uLongf compressedSize = compressBound(runs.size());
+	compressed.resize(compressedSize + 8);
+	bool ok = compress2(&compressed[8], &compressedSize, runs.size() ? &runs[0] : &empty, runs.size(), 1) == Z_OK;
+	if (ok)
+	{
+		std::vector<unsigned char> sizes;
+		writeU32(sizes, runs.size());
+		writeU32(sizes, compressedSize);
+		std::copy(sizes.begin(), sizes.end(), compressed.begin());
+		file.write(reinterpret_cast<const char *>(&compressed[0]), compressedSize + 8);
+		// flushed so that a full disk shows up as a failure straight away
+		file.flush();
+		ok = bool(file);
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (ok)
+		framesWritten++;
+	else
+		failed = true;
+}
+
+RecordingReader::RecordingReader(ByteString filename):
+	width(0),
+	height(0),
+	damaged(false)
+{
+	file.open(filename.c_str(), std::ios::binary);
+	size_t magicSize = strlen(recording::magic);
+	std::vector<unsigned char> header(magicSize + 12);
+	if (!file.read(reinterpret_cast<char *>(&header[0]), header.size()))
+		return;
+	if (memcmp(&header[0], recording::magic, magicSize) || readU32(&header[magicSize]) != (uint32_t)recording::version)
+		return;
+	int newWidth = readU32(&header[magicSize + 4]);
+	int newHeight = readU32(&header[magicSize + 8]);
+	if (newWidth <= 0 || newHeight <= 0 || newWidth > 0x4000 || newHeight > 0x4000)
+		return;
+	width = newWidth;
+	height = newHeight;
+}
+
+bool RecordingReader::ReadFrame(std::vector<pixel> &frame)
+{
+	if (!IsOpen() || damaged)
+		return false;
+	// a recording may only end between frames
+	if (file.peek() == std::ifstream::traits_type::eof())
+		return false;
+	if (!DecodeFrame(frame))
+	{
+		damaged = true;
+		return false;
+	}
+	return true;
+}
+
+bool RecordingReader::DecodeFrame(std::vector<pixel> &frame)
+{
+	unsigned char sizes[8];
+	if (!file.read(reinterpret_cast<char *>(sizes), 8))
+		return false;
+	uLongf rawSize = readU32(sizes);
+	uint32_t compressedSize = readU32(sizes + 4);
+	// at worst every pixel is its own run
+	if (rawSize > uLongf(width) * height * 11 || compressedSize > compressBound(rawSize))
+		return false;
+	compressed.resize(compressedSize + 1);
+	runs.resize(rawSize + 1);
+	if (!file.read(reinterpret_cast<char *>(&compressed[0]), compressedSize))
+		return false;
+	uLongf decompressedSize = rawSize;
+	if (uncompress(&runs[0], &decompressedSize, &compressed[0], compressedSize) != Z_OK || decompressedSize != rawSize)
+		return false;
+
+	size_t size = size_t(width) * height;
+	frame.resize(size);
+	size_t pos = 0, pixelIndex = 0;
+	while (pos + 8 <= rawSize)
+	{
+		size_t skip = readU32(&runs[pos]);
+		size_t length = readU32(&runs[pos + 4]);
+		pos += 8;
+		if (skip > size - pixelIndex || length > size - pixelIndex - skip || length * 3 > rawSize - pos)
+			return false;
+		pixelIndex += skip;
+		for (size_t j = 0; j < length; j++, pos += 3)
+			frame[pixelIndex + j] = PIXRGB(runs[pos], runs[pos + 1], runs[pos + 2]);
+		pixelIndex += length;
+	}
+	return pos == rawSize;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "Config.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/String.h"
+#include "Pixel.h"
+
+// A recording is a single file: a header with the frame size, then one
+// zlib-compressed record per frame listing only the runs of pixels that
+// changed since the previous frame. Pixels are stored as RGB bytes.
+namespace recording
+{
+	const static char magic[] = "TPTREC";
+	const static int version = 1;
+}
+
+// Encodes and writes frames on a background thread. AddFrame only queues
+// the frame, and blocks if the writer has fallen maxQueued frames behind.
+class RecordingWriter
+{
+	int width, height;
+	size_t maxQueued;
+	std::ofstream file;
+	bool failed;
+	int framesWritten;
+
+	std::deque<std::vector<pixel> > queue;
+	bool done;
+	std::mutex mutex;
+	std::condition_variable frameAvailable;
+	std::condition_variable spaceAvailable;
+	std::thread thread;
+
+	std::vector<pixel> previous;
+	std::vector<unsigned char> runs;
+	std::vector<unsigned char> compressed;
+
+	void Run();
+	void WriteFrame(const std::vector<pixel> &frame);
+
+public:
+	RecordingWriter(ByteString filename, int width, int height, size_t maxQueued = 16);
+	// waits for all queued frames to be written
+	~RecordingWriter();
+
+	void AddFrame(std::vector<pixel> frame);
+	bool Failed();
+	int GetFramesWritten();
+};
+
+class RecordingReader
+{
+	int width, height;
+	bool damaged;
+	std::ifstream file;
+	std::vector<unsigned char> runs;
+	std::vector<unsigned char> compressed;
+
+	bool DecodeFrame(std::vector<pixel> &frame);
+
+public:
+	RecordingReader(ByteString filename);
+
+	bool IsOpen() { return width > 0; }
+	int GetWidth() { return width; }
+	int GetHeight() { return height; }
+	// applies the next frame's changes to frame, which should start out empty;
+	// returns false at the end of the recording or if it is damaged
+	bool ReadFrame(std::vector<pixel> &frame);
+	// whether reading stopped at a truncated or corrupt frame rather than
+	// at the end of the last whole one
+	bool IsDamaged() { return damaged; }
+};
@@ -1,5 +1,7 @@
 #include "Renderer.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <iostream>
 #include <iomanip>
@@ -38,6 +40,48 @@
 #define VIDYRES YRES
 #endif
 
+#ifndef OGLR
+// The pixel drawing methods leave pixels outside this rectangle alone. It is
+// the whole of vid except on threads drawing tiles, where it is their tile.
+struct ClipRect
+{
+	int x1, y1, x2, y2;
+};
+static thread_local ClipRect drawClip = { 0, 0, VIDXRES, VIDYRES };
+#define PIXELMETHODS_CLIPPED(x, y) ((x)<drawClip.x1 || (y)<drawClip.y1 || (x)>=drawClip.x2 || (y)>=drawClip.y2)
+
+// width and height of the tiles particles are drawn in with tileThreads set
+#define RENDERER_TILE 64
+#endif
+
+// The software post-processing passes (persistent display, gravity lensing
+// and fire) work on four pixels at a time with SSE2 when pixels are in the
+// default 00RRGGBB layout. The vector code gives exactly the same results as
+// the scalar code, which other layouts and builds without SSE2 use.
+#if defined(X86_SSE2) && !defined(PIX16) && !defined(PIX32BGRA) && !defined(PIX32OGL)
+# define RENDERER_SSE2
+# include <emmintrin.h>
+#endif
+
+// persistentVid is the previous frame with every channel one step darker
+static void fadePersistent(const pixel * src, pixel * dst, int count)
+{
+	int i = 0;
+#ifdef RENDERER_SSE2
+	__m128i one = _mm_set1_epi32(0x010101), rgb = _mm_set1_epi32(0xFFFFFF);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i p = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_and_si128(_mm_subs_epu8(p, one), rgb));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		int r = PIXR(src[i]), g = PIXG(src[i]), b = PIXB(src[i]);
+		dst[i] = PIXRGB(r>0 ? r-1 : 0, g>0 ? g-1 : 0, b>0 ? b-1 : 0);
+	}
+}
+
 
 void Renderer::RenderBegin()
 {
@@ -74,20 +118,7 @@ void Renderer::RenderBegin()
 	render_parts();
 	if(display_mode & DISPLAY_PERS)
 	{
-		int i,r,g,b;
-		for (i = 0; i < VIDXRES*YRES; i++)
-		{
-			r = PIXR(vid[i]);
-			g = PIXG(vid[i]);
-			b = PIXB(vid[i]);
-			if (r>0)
-				r--;
-			if (g>0)
-				g--;
-			if (b>0)
-				b--;
-			persistentVid[i] = PIXRGB(r,g,b);
-		}
+		fadePersistent(vid, persistentVid, VIDXRES*YRES);
 	}
 
 	render_fire();
@@ -120,20 +151,7 @@ void Renderer::RenderBegin()
 	
 	if(display_mode & DISPLAY_PERS)
 	{
-		int i,r,g,b;
-		for (i = 0; i < VIDXRES*YRES; i++)
-		{
-			r = PIXR(vid[i]);
-			g = PIXG(vid[i]);
-			b = PIXB(vid[i]);
-			if (r>0)
-				r--;
-			if (g>0)
-				g--;
-			if (b>0)
-				b--;
-			persistentVid[i] = PIXRGB(r,g,b);
-		}
+		fadePersistent(vid, persistentVid, VIDXRES*YRES);
 	}
 
 	render_fire();
@@ -168,6 +186,69 @@ void Renderer::RenderEnd()
 #endif
 }
 
+bool Renderer::LuaGraphicsInUse()
+{
+#if !defined(RENDERER) && defined(LUACONSOLE)
+	return luacon_graphicsFuncsInUse();
+#else
+	return false;
+#endif
+}
+
+bool Renderer::RenderBeginPipelined()
+{
+#ifdef OGLI
+	return false;
+#else
+	if (!pipelined || pipelineThread.joinable())
+		return false;
+	if (LuaGraphicsInUse())
+		return false;
+	if (!pipelineSim)
+		pipelineSim.reset(new Simulation());
+	pipelineSim->CopyRenderState(*sim);
+
+	liveSim = sim;
+	liveVid = vid;
+	liveRng = rng;
+	sim = pipelineSim.get();
+	vid = pipelineVid;
+	rng = &pipelineRng;
+	std::fill(pipelineVid, pipelineVid+(VIDXRES*VIDYRES), 0);
+	pipelineThread = std::thread([this]() {
+		// element graphics functions draw random numbers too
+		RNG::SetThreadInstance(&pipelineRng);
+		RenderBegin();
+	});
+	return true;
+#endif
+}
+
+void Renderer::RenderWaitPipelined()
+{
+	if (!pipelineThread.joinable())
+		return;
+	pipelineThread.join();
+	sim = liveSim;
+	vid = liveVid;
+	rng = liveRng;
+
+	SimulationTimings &timings = pipelineSim->timings;
+	sim->timings.nanoseconds[SimulationTimings::PHASE_RENDER] += timings.nanoseconds[SimulationTimings::PHASE_RENDER];
+	sim->timings.calls[SimulationTimings::PHASE_RENDER] += timings.calls[SimulationTimings::PHASE_RENDER];
+	timings.Reset();
+	pipelineFrameReady = true;
+}
+
+bool Renderer::PresentPipelined()
+{
+	if (!pipelineFrameReady)
+		return false;
+	pipelineFrameReady = false;
+	std::copy(pipelineVid, pipelineVid+(VIDXRES*VIDYRES), vid);
+	return true;
+}
+
 void Renderer::SetSample(int x, int y)
 {
 	sampleColor = GetPixel(x, y);
@@ -1032,37 +1113,70 @@ void Renderer::DrawSigns()
 void Renderer::render_gravlensing(pixel * source)
 {
 #ifndef OGLR
-	int nx, ny, rx, ry, gx, gy, bx, by, co;
-	int r, g, b;
-	pixel t;
 	pixel *src = source;
 	pixel *dst = vid;
 	if (!dst)
 		return;
-	for(nx = 0; nx < XRES; nx++)
-	{
-		for(ny = 0; ny < YRES; ny++)
-		{
-			co = (ny/CELL)*(XRES/CELL)+(nx/CELL);
-			rx = (int)(nx-sim->gravx[co]*0.75f+0.5f);
-			ry = (int)(ny-sim->gravy[co]*0.75f+0.5f);
-			gx = (int)(nx-sim->gravx[co]*0.875f+0.5f);
-			gy = (int)(ny-sim->gravy[co]*0.875f+0.5f);
-			bx = (int)(nx-sim->gravx[co]+0.5f);
-			by = (int)(ny-sim->gravy[co]+0.5f);
-			if(rx >= 0 && rx < XRES && ry >= 0 && ry < YRES && gx >= 0 && gx < XRES && gy >= 0 && gy < YRES && bx >= 0 && bx < XRES && by >= 0 && by < YRES)
+#ifdef RENDERER_SSE2
+	__m128i rgb = _mm_set1_epi32(0xFFFFFF);
+#endif
+	// row by row, a cell wide run of pixels at a time, since every pixel of
+	// a run is bent by the same field and reads the same source rows
+	for (int ny = 0; ny < YRES; ny++)
+	{
+		pixel *row = dst + ny*(VIDXRES);
+		for (int cx = 0; cx < XRES/CELL; cx++)
+		{
+			int co = (ny/CELL)*(XRES/CELL)+cx;
+			float fx = sim->gravx[co], fy = sim->gravy[co];
+			int ry = (int)(ny-fy*0.75f+0.5f);
+			int gy = (int)(ny-fy*0.875f+0.5f);
+			int by = (int)(ny-fy+0.5f);
+			if (!(ry >= 0 && ry < YRES && gy >= 0 && gy < YRES && by >= 0 && by < YRES))
+				continue;
+			const pixel *srcR = src + ry*(VIDXRES), *srcG = src + gy*(VIDXRES), *srcB = src + by*(VIDXRES);
+
+			// the red, green and blue each come from a different distance
+			// away, a pixel with any of them off screen is left alone
+			pixel light[CELL];
+			pixel inside[CELL];
+			for (int i = 0; i < CELL; i++)
+			{
+				int nx = cx*CELL+i;
+				int rx = (int)(nx-fx*0.75f+0.5f);
+				int gx = (int)(nx-fx*0.875f+0.5f);
+				int bx = (int)(nx-fx+0.5f);
+				bool in = rx >= 0 && rx < XRES && gx >= 0 && gx < XRES && bx >= 0 && bx < XRES;
+				light[i] = in ? PIXRGB(PIXR(srcR[rx]), PIXG(srcG[gx]), PIXB(srcB[bx])) : 0;
+				inside[i] = in ? ~pixel(0) : 0;
+			}
+
+			pixel *run = row + cx*CELL;
+			int i = 0;
+#ifdef RENDERER_SSE2
+			for (; i + 4 <= CELL; i += 4)
+			{
+				__m128i t = _mm_loadu_si128((const __m128i *)(run + i));
+				__m128i sum = _mm_and_si128(_mm_adds_epu8(t, _mm_loadu_si128((const __m128i *)(light + i))), rgb);
+				__m128i mask = _mm_loadu_si128((const __m128i *)(inside + i));
+				_mm_storeu_si128((__m128i *)(run + i), _mm_or_si128(_mm_and_si128(mask, sum), _mm_andnot_si128(mask, t)));
+			}
+#endif
+			for (; i < CELL; i++)
 			{
-				t = dst[ny*(VIDXRES)+nx];
-				r = PIXR(src[ry*(VIDXRES)+rx]) + PIXR(t);
-				g = PIXG(src[gy*(VIDXRES)+gx]) + PIXG(t);
-				b = PIXB(src[by*(VIDXRES)+bx]) + PIXB(t);
+				if (!inside[i])
+					continue;
+				pixel t = run[i];
+				int r = PIXR(light[i]) + PIXR(t);
+				int g = PIXG(light[i]) + PIXG(t);
+				int b = PIXB(light[i]) + PIXB(t);
 				if (r>255)
 					r = 255;
 				if (g>255)
 					g = 255;
 				if (b>255)
 					b = 255;
-				dst[ny*(VIDXRES)+nx] = PIXRGB(r,g,b);
+				run[i] = PIXRGB(r,g,b);
 			}
 		}
 	}
@@ -1074,7 +1188,29 @@ void Renderer::render_fire()
 #ifndef OGLR
 	if(!(render_mode & FIREMODE))
 		return;
-	int i,j,x,y,r,g,b,a;
+	int i,j,x,y,r,g,b;
+	int alpha[CELL*3][CELL*3];
+	for (y=0; y<CELL*3; y++)
+		for (x=0; x<CELL*3; x++)
+			alpha[y][x] = findingElement ? fire_alpha[y][x]/2 : fire_alpha[y][x];
+#ifdef RENDERER_SSE2
+	// alpha for each channel of each pixel, as addpixel's products need 16 bits
+	short alphaLanes[CELL*3][CELL*3*4];
+	for (y=0; y<CELL*3; y++)
+		for (x=0; x<CELL*3*4; x++)
+			alphaLanes[y][x] = short(alpha[y][x/4]);
+	__m128i zero = _mm_setzero_si128(), lowByte = _mm_set1_epi16(0xFF), rgb = _mm_set1_epi32(0xFFFFFF);
+	// addpixel's (a*c + 255*t) >> 8 for four channels of two pixels, summing
+	// the high and low bytes of the products separately so nothing overflows
+	auto add = [lowByte](__m128i t, __m128i a, __m128i c) {
+		__m128i ac = _mm_mullo_epi16(a, c);
+		__m128i tt = _mm_mullo_epi16(t, lowByte);
+		__m128i carry = _mm_srli_epi16(_mm_add_epi16(_mm_and_si128(ac, lowByte), _mm_and_si128(tt, lowByte)), 8);
+		return _mm_add_epi16(_mm_add_epi16(_mm_srli_epi16(ac, 8), _mm_srli_epi16(tt, 8)), carry);
+	};
+#endif
+	// each cell with fire adds a blurred 3x3 cell stamp around it, in the
+	// same order addpixel would, row by row
 	for (j=0; j<YRES/CELL; j++)
 		for (i=0; i<XRES/CELL; i++)
 		{
@@ -1082,14 +1218,37 @@ void Renderer::render_fire()
 			g = fire_g[j][i];
 			b = fire_b[j][i];
 			if (r || g || b)
-				for (y=-CELL; y<2*CELL; y++)
-					for (x=-CELL; x<2*CELL; x++)
+			{
+				int x1 = std::max(-CELL, -i*CELL), x2 = std::min(2*CELL, VIDXRES-i*CELL);
+				int y1 = std::max(-CELL, -j*CELL), y2 = std::min(2*CELL, VIDYRES-j*CELL);
+#ifdef RENDERER_SSE2
+				__m128i colour = _mm_setr_epi16(b, g, r, 0, b, g, r, 0);
+#endif
+				for (y=y1; y<y2; y++)
+				{
+					pixel *row = vid + (j*CELL+y)*(VIDXRES) + i*CELL;
+					x = x1;
+#ifdef RENDERER_SSE2
+					for (; x + 4 <= x2; x += 4)
 					{
-						a = fire_alpha[y+CELL][x+CELL];
-						if (findingElement)
-							a /= 2;
-						addpixel(i*CELL+x, j*CELL+y, r, g, b, a);
+						__m128i t = _mm_loadu_si128((const __m128i *)(row + x));
+						const short *a = &alphaLanes[y+CELL][(x+CELL)*4];
+						__m128i lo = add(_mm_unpacklo_epi8(t, zero), _mm_loadu_si128((const __m128i *)a), colour);
+						__m128i hi = add(_mm_unpackhi_epi8(t, zero), _mm_loadu_si128((const __m128i *)(a + 8)), colour);
+						_mm_storeu_si128((__m128i *)(row + x), _mm_and_si128(_mm_packus_epi16(lo, hi), rgb));
 					}
+#endif
+					for (; x < x2; x++)
+					{
+						pixel t = row[x];
+						int a = alpha[y+CELL][x+CELL];
+						int nr = (a*r + 255*PIXR(t)) >> 8;
+						int ng = (a*g + 255*PIXG(t)) >> 8;
+						int nb = (a*b + 255*PIXB(t)) >> 8;
+						row[x] = PIXRGB(std::min(nr, 255), std::min(ng, 255), std::min(nb, 255));
+					}
+				}
+			}
 			r *= 8;
 			g *= 8;
 			b *= 8;
@@ -1197,19 +1356,720 @@ void Renderer::prepare_alpha(int size, float intensity)
 }
 
 #ifndef FONTEDITOR
-void Renderer::render_parts()
+#ifndef OGLR
+// how far the rays of a spark or flare go, which are drawn while gradv is
+// above 0.5 and divided by decay every pixel, give or take a pixel
+static int rayReach(float gradv, float decay)
+{
+	if (!(gradv > 0.5f))
+		return 0;
+	return int(std::log(gradv * 2) / std::log(decay)) + 2;
+}
+#endif
+
+// Works out how particle i is drawn, returning false if it isn't. This calls
+// the element and Lua graphics functions and draws the random flicker, so it
+// is always called for every particle in order on the thread rendering.
+bool Renderer::prepare_part(int i, PartRender & part)
 {
-	int deca, decr, decg, decb, cola, colr, colg, colb, firea, firer, fireg, fireb, pixel_mode, q, i, t, nx, ny, x, y, caddress;
+	int deca, decr, decg, decb, cola, colr, colg, colb, firea, firer, fireg, fireb, pixel_mode, q, t, nx, ny, caddress;
+	float gradv;
+	Particle * parts = sim->parts;
+	Element * elements = sim->elements.data();
+	if (!sim->parts[i].type || sim->parts[i].type < 0 || sim->parts[i].type >= PT_NUM)
+		return false;
+	t = sim->parts[i].type;
+
+	nx = (int)(sim->parts[i].x+0.5f);
+	ny = (int)(sim->parts[i].y+0.5f);
+
+	if(nx >= XRES || nx < 0 || ny >= YRES || ny < 0)
+		return false;
+	if(TYP(sim->photons[ny][nx]) && !(sim->elements[t].Properties & TYPE_ENERGY) && t!=PT_STKM && t!=PT_STKM2 && t!=PT_FIGH)
+		return false;
+
+	//Defaults
+	pixel_mode = 0 | PMODE_FLAT;
+	cola = 255;
+	colr = PIXR(elements[t].Colour);
+	colg = PIXG(elements[t].Colour);
+	colb = PIXB(elements[t].Colour);
+	firer = fireg = fireb = firea = 0;
+
+	deca = (sim->parts[i].dcolour>>24)&0xFF;
+	decr = (sim->parts[i].dcolour>>16)&0xFF;
+	decg = (sim->parts[i].dcolour>>8)&0xFF;
+	decb = (sim->parts[i].dcolour)&0xFF;
+
+	if(decorations_enable && blackDecorations)
+	{
+		if(deca < 250 || decr > 5 || decg > 5 || decb > 5)
+			deca = 0;
+		else
+		{
+			deca = 255;
+			decr = decg = decb = 0;
+		}
+	}
+
+	if (graphicscache[t].isready)
+	{
+		pixel_mode = graphicscache[t].pixel_mode;
+		cola = graphicscache[t].cola;
+		colr = graphicscache[t].colr;
+		colg = graphicscache[t].colg;
+		colb = graphicscache[t].colb;
+		firea = graphicscache[t].firea;
+		firer = graphicscache[t].firer;
+		fireg = graphicscache[t].fireg;
+		fireb = graphicscache[t].fireb;
+	}
+	else if(!(colour_mode & COLOUR_BASC))
+	{
+		if (elements[t].Graphics)
+		{
+#if !defined(RENDERER) && defined(LUACONSOLE)
+			if (lua_gr_func && lua_gr_func[t])
+			{
+				if (luacon_graphicsReplacement(this, &(sim->parts[i]), nx, ny, &pixel_mode, &cola, &colr, &colg, &colb, &firea, &firer, &fireg, &fireb, i))
+				{
+					graphicscache[t].isready = 1;
+					graphicscache[t].pixel_mode = pixel_mode;
+					graphicscache[t].cola = cola;
+					graphicscache[t].colr = colr;
+					graphicscache[t].colg = colg;
+					graphicscache[t].colb = colb;
+					graphicscache[t].firea = firea;
+					graphicscache[t].firer = firer;
+					graphicscache[t].fireg = fireg;
+					graphicscache[t].fireb = fireb;
+				}
+			}
+			else if ((*(elements[t].Graphics))(this, &(sim->parts[i]), nx, ny, &pixel_mode, &cola, &colr, &colg, &colb, &firea, &firer, &fireg, &fireb)) //That's a lot of args, a struct might be better
+#else
+			if ((*(elements[t].Graphics))(this, &(sim->parts[i]), nx, ny, &pixel_mode, &cola, &colr, &colg, &colb, &firea, &firer, &fireg, &fireb)) //That's a lot of args, a struct might be better
+#endif
+			{
+				graphicscache[t].isready = 1;
+				graphicscache[t].pixel_mode = pixel_mode;
+				graphicscache[t].cola = cola;
+				graphicscache[t].colr = colr;
+				graphicscache[t].colg = colg;
+				graphicscache[t].colb = colb;
+				graphicscache[t].firea = firea;
+				graphicscache[t].firer = firer;
+				graphicscache[t].fireg = fireg;
+				graphicscache[t].fireb = fireb;
+			}
+		}
+		else
+		{
+			graphicscache[t].isready = 1;
+			graphicscache[t].pixel_mode = pixel_mode;
+			graphicscache[t].cola = cola;
+			graphicscache[t].colr = colr;
+			graphicscache[t].colg = colg;
+			graphicscache[t].colb = colb;
+			graphicscache[t].firea = firea;
+			graphicscache[t].firer = firer;
+			graphicscache[t].fireg = fireg;
+			graphicscache[t].fireb = fireb;
+		}
+	}
+	if((elements[t].Properties & PROP_HOT_GLOW) && sim->parts[i].temp>(elements[t].HighTemperature-800.0f))
+	{
+		gradv = 3.1415/(2*elements[t].HighTemperature-(elements[t].HighTemperature-800.0f));
+		caddress = int((sim->parts[i].temp>elements[t].HighTemperature)?elements[t].HighTemperature-(elements[t].HighTemperature-800.0f):sim->parts[i].temp-(elements[t].HighTemperature-800.0f));
+		colr += int(sin(gradv*caddress) * 226);
+		colg += int(sin(gradv*caddress*4.55 +3.14) * 34);
+		colb += int(sin(gradv*caddress*2.22 +3.14) * 64);
+	}
+
+	if((pixel_mode & FIRE_ADD) && !(render_mode & FIRE_ADD))
+		pixel_mode |= PMODE_GLOW;
+	if((pixel_mode & FIRE_BLEND) && !(render_mode & FIRE_BLEND))
+		pixel_mode |= PMODE_BLUR;
+	if((pixel_mode & PMODE_BLUR) && !(render_mode & PMODE_BLUR))
+		pixel_mode |= PMODE_FLAT;
+	if((pixel_mode & PMODE_GLOW) && !(render_mode & PMODE_GLOW))
+		pixel_mode |= PMODE_BLEND;
+	if (render_mode & PMODE_BLOB)
+		pixel_mode |= PMODE_BLOB;
+
+	pixel_mode &= render_mode;
+
+	//Alter colour based on display mode
+	if(colour_mode & COLOUR_HEAT)
+	{
+		constexpr float min_temp = MIN_TEMP;
+		constexpr float max_temp = MAX_TEMP;
+		caddress = int(restrict_flt((sim->parts[i].temp - min_temp) / (max_temp - min_temp) * 1024, 0, 1023)) * 3;
+		firea = 255;
+		firer = colr = color_data[caddress];
+		fireg = colg = color_data[caddress+1];
+		fireb = colb = color_data[caddress+2];
+		cola = 255;
+		if(pixel_mode & (FIREMODE | PMODE_GLOW))
+			pixel_mode = (pixel_mode & ~(FIREMODE|PMODE_GLOW)) | PMODE_BLUR;
+		else if ((pixel_mode & (PMODE_BLEND | PMODE_ADD)) == (PMODE_BLEND | PMODE_ADD))
+			pixel_mode = (pixel_mode & ~(PMODE_BLEND|PMODE_ADD)) | PMODE_FLAT;
+		else if (!pixel_mode)
+			pixel_mode |= PMODE_FLAT;
+	}
+	else if(colour_mode & COLOUR_LIFE)
+	{
+		gradv = 0.4f;
+		if (!(sim->parts[i].life<5))
+			q = int(sqrt((float)sim->parts[i].life));
+		else
+			q = sim->parts[i].life;
+		colr = colg = colb = int(sin(gradv*q) * 100 + 128);
+		cola = 255;
+		if(pixel_mode & (FIREMODE | PMODE_GLOW))
+			pixel_mode = (pixel_mode & ~(FIREMODE|PMODE_GLOW)) | PMODE_BLUR;
+		else if ((pixel_mode & (PMODE_BLEND | PMODE_ADD)) == (PMODE_BLEND | PMODE_ADD))
+			pixel_mode = (pixel_mode & ~(PMODE_BLEND|PMODE_ADD)) | PMODE_FLAT;
+		else if (!pixel_mode)
+			pixel_mode |= PMODE_FLAT;
+	}
+	else if(colour_mode & COLOUR_BASC)
+	{
+		colr = PIXR(elements[t].Colour);
+		colg = PIXG(elements[t].Colour);
+		colb = PIXB(elements[t].Colour);
+		pixel_mode = PMODE_FLAT;
+	}
+
+	//Apply decoration colour
+	if(!(colour_mode & ~COLOUR_GRAD) && decorations_enable && deca)
+	{
+		deca++;
+		if(!(pixel_mode & NO_DECO))
+		{
+			colr = (deca*decr + (256-deca)*colr) >> 8;
+			colg = (deca*decg + (256-deca)*colg) >> 8;
+			colb = (deca*decb + (256-deca)*colb) >> 8;
+		}
+
+		if(pixel_mode & DECO_FIRE)
+		{
+			firer = (deca*decr + (256-deca)*firer) >> 8;
+			fireg = (deca*decg + (256-deca)*fireg) >> 8;
+			fireb = (deca*decb + (256-deca)*fireb) >> 8;
+		}
+	}
+
+	if (colour_mode & COLOUR_GRAD)
+	{
+		auto frequency = 0.05f;
+		auto q = int(sim->parts[i].temp-40);
+		colr = int(sin(frequency*q) * 16 + colr);
+		colg = int(sin(frequency*q) * 16 + colg);
+		colb = int(sin(frequency*q) * 16 + colb);
+		if(pixel_mode & (FIREMODE | PMODE_GLOW)) pixel_mode = (pixel_mode & ~(FIREMODE|PMODE_GLOW)) | PMODE_BLUR;
+	}
+
+#ifndef OGLR
+	//All colours are now set, check ranges
+	if(colr>255) colr = 255;
+	else if(colr<0) colr = 0;
+	if(colg>255) colg = 255;
+	else if(colg<0) colg = 0;
+	if(colb>255) colb = 255;
+	else if(colb<0) colb = 0;
+	if(cola>255) cola = 255;
+	else if(cola<0) cola = 0;
+
+	if(firer>255) firer = 255;
+	else if(firer<0) firer = 0;
+	if(fireg>255) fireg = 255;
+	else if(fireg<0) fireg = 0;
+	if(fireb>255) fireb = 255;
+	else if(fireb<0) fireb = 0;
+	if(firea>255) firea = 255;
+	else if(firea<0) firea = 0;
+#endif
+
+	if (findingElement)
+	{
+		if (TYP(findingElement) == parts[i].type &&
+				(parts[i].type != PT_LIFE || (ID(findingElement) == parts[i].ctype)))
+		{
+			colr = firer = 255;
+			colg = fireg = colb = fireb = 0;
+			foundElements++;
+		}
+		else
+		{
+			colr /= 10;
+			colg /= 10;
+			colb /= 10;
+			firer /= 5;
+			fireg /= 5;
+			fireb /= 5;
+		}
+	}
+
+
+	part.cplayer = nullptr;
+	if(pixel_mode & PSPEC_STICKMAN)
+	{
+		playerst *cplayer;
+		if(t==PT_STKM)
+			cplayer = &sim->player;
+		else if(t==PT_STKM2)
+			cplayer = &sim->player2;
+		else if (t==PT_FIGH && sim->parts[i].tmp >= 0 && sim->parts[i].tmp < MAX_FIGHTERS)
+			cplayer = &sim->fighters[(unsigned char)sim->parts[i].tmp];
+		else
+			return false;
+		part.cplayer = cplayer;
+
+		if (findingElement == t)
+		{
+			colr = 255;
+			colg = colb = 0;
+		}
+		else if (colour_mode != COLOUR_HEAT)
+		{
+			if (cplayer->fan)
+			{
+				colr = PIXR(0x8080FF);
+				colg = PIXG(0x8080FF);
+				colb = PIXB(0x8080FF);
+			}
+			else if (cplayer->elem < PT_NUM && cplayer->elem > 0)
+			{
+				colr = PIXR(elements[cplayer->elem].Colour);
+				colg = PIXG(elements[cplayer->elem].Colour);
+				colb = PIXB(elements[cplayer->elem].Colour);
+			}
+			else
+			{
+				colr = 0x80;
+				colg = 0x80;
+				colb = 0xFF;
+			}
+		}
+#ifndef OGLR
+		int legr, legg, legb;
+		if (findingElement && findingElement == t)
+		{
+			legr = 255;
+			legg = legb = 0;
+		}
+		else if (colour_mode==COLOUR_HEAT)
+		{
+			legr = colr;
+			legg = colg;
+			legb = colb;
+		}
+		else if (t==PT_STKM2)
+		{
+			legr = 100;
+			legg = 100;
+			legb = 255;
+		}
+		else
+		{
+			legr = 255;
+			legg = 255;
+			legb = 255;
+		}
+
+		if (findingElement && findingElement != t)
+		{
+			colr /= 10;
+			colg /= 10;
+			colb /= 10;
+			legr /= 10;
+			legg /= 10;
+			legb /= 10;
+		}
+		part.legr = legr;
+		part.legg = legg;
+		part.legb = legb;
+#endif
+	}
+
+	if(pixel_mode & PMODE_SPARK)
+		part.sparkFlicker = float((*rng)()%20);
+	if(pixel_mode & PMODE_FLARE)
+		part.flareFlicker = float((*rng)()%20);
+	if(pixel_mode & PMODE_LFLARE)
+		part.lflareFlicker = float((*rng)()%20);
+
+	part.i = i;
+	part.nx = nx;
+	part.ny = ny;
+	part.pixel_mode = pixel_mode;
+	part.cola = cola;
+	part.colr = colr;
+	part.colg = colg;
+	part.colb = colb;
+	part.firea = firea;
+	part.firer = firer;
+	part.fireg = fireg;
+	part.fireb = fireb;
+	return true;
+}
+
+#ifndef OGLR
+// Draws a particle as prepare_part worked out, leaving pixels outside the clip
+// rectangle alone. The fire effects are left to render_parts.
+void Renderer::draw_part(const PartRender & part)
+{
+	int i = part.i, t = sim->parts[i].type, nx = part.nx, ny = part.ny, pixel_mode = part.pixel_mode, x, y;
+	int cola = part.cola, colr = part.colr, colg = part.colg, colb = part.colb;
 	int orbd[4] = {0, 0, 0, 0}, orbl[4] = {0, 0, 0, 0};
 	float gradv, flicker;
-	Particle * parts;
-	Element *elements;
+	Particle * parts = sim->parts;
+
+	if (pixel_mode & EFFECT_LINES)
+	{
+		if (t==PT_SOAP)
+		{
+			if ((parts[i].ctype&3) == 3 && parts[i].tmp >= 0 && parts[i].tmp < NPART)
+				draw_line(nx, ny, (int)(parts[parts[i].tmp].x+0.5f), (int)(parts[parts[i].tmp].y+0.5f), colr, colg, colb, cola);
+		}
+	}
+	if(pixel_mode & PSPEC_STICKMAN)
+	{
+		playerst *cplayer = part.cplayer;
+		int legr = part.legr, legg = part.legg, legb = part.legb;
+		if (mousePos.X>(nx-3) && mousePos.X<(nx+3) && mousePos.Y<(ny+3) && mousePos.Y>(ny-3)) //If mouse is in the head
+		{
+			String hp = String::Build(Format::Width(sim->parts[i].life, 3));
+			drawtext(mousePos.X-8-2*(sim->parts[i].life<100)-2*(sim->parts[i].life<10), mousePos.Y-12, hp, 255, 255, 255, 255);
+		}
+
+		//head
+		if(t==PT_FIGH)
+		{
+			draw_line(nx, ny+2, nx+2, ny, colr, colg, colb, 255);
+			draw_line(nx+2, ny, nx, ny-2, colr, colg, colb, 255);
+			draw_line(nx, ny-2, nx-2, ny, colr, colg, colb, 255);
+			draw_line(nx-2, ny, nx, ny+2, colr, colg, colb, 255);
+		}
+		else
+		{
+			draw_line(nx-2, ny+2, nx+2, ny+2, colr, colg, colb, 255);
+			draw_line(nx-2, ny-2, nx+2, ny-2, colr, colg, colb, 255);
+			draw_line(nx-2, ny-2, nx-2, ny+2, colr, colg, colb, 255);
+			draw_line(nx+2, ny-2, nx+2, ny+2, colr, colg, colb, 255);
+		}
+		//legs
+		draw_line(nx, ny+3, int(cplayer->legs[0]), int(cplayer->legs[1]), legr, legg, legb, 255);
+		draw_line(int(cplayer->legs[0]), int(cplayer->legs[1]), int(cplayer->legs[4]), int(cplayer->legs[5]), legr, legg, legb, 255);
+		draw_line(nx, ny+3, int(cplayer->legs[8]), int(cplayer->legs[9]), legr, legg, legb, 255);
+		draw_line(int(cplayer->legs[8]), int(cplayer->legs[9]), int(cplayer->legs[12]), int(cplayer->legs[13]), legr, legg, legb, 255);
+		if (cplayer->rocketBoots)
+		{
+			for (int leg=0; leg<2; leg++)
+			{
+				int nx = int(cplayer->legs[leg*8+4]), ny = int(cplayer->legs[leg*8+5]);
+				int colr = 255, colg = 0, colb = 255;
+				if (((int)(cplayer->comm)&0x04) == 0x04 || (((int)(cplayer->comm)&0x01) == 0x01 && leg==0) || (((int)(cplayer->comm)&0x02) == 0x02 && leg==1))
+					blendpixel(nx, ny, 0, 255, 0, 255);
+				else
+					blendpixel(nx, ny, 255, 0, 0, 255);
+				blendpixel(nx+1, ny, colr, colg, colb, 223);
+				blendpixel(nx-1, ny, colr, colg, colb, 223);
+				blendpixel(nx, ny+1, colr, colg, colb, 223);
+				blendpixel(nx, ny-1, colr, colg, colb, 223);
+
+				blendpixel(nx+1, ny-1, colr, colg, colb, 112);
+				blendpixel(nx-1, ny-1, colr, colg, colb, 112);
+				blendpixel(nx+1, ny+1, colr, colg, colb, 112);
+				blendpixel(nx-1, ny+1, colr, colg, colb, 112);
+			}
+		}
+	}
+	if(pixel_mode & PMODE_FLAT)
+	{
+		if (!PIXELMETHODS_CLIPPED(nx, ny))
+			vid[ny*(VIDXRES)+nx] = PIXRGB(colr,colg,colb);
+	}
+	if(pixel_mode & PMODE_BLEND)
+	{
+		blendpixel(nx, ny, colr, colg, colb, cola);
+	}
+	if(pixel_mode & PMODE_ADD)
+	{
+		addpixel(nx, ny, colr, colg, colb, cola);
+	}
+	if(pixel_mode & PMODE_BLOB)
+	{
+		if (!PIXELMETHODS_CLIPPED(nx, ny))
+			vid[ny*(VIDXRES)+nx] = PIXRGB(colr,colg,colb);
+
+		blendpixel(nx+1, ny, colr, colg, colb, 223);
+		blendpixel(nx-1, ny, colr, colg, colb, 223);
+		blendpixel(nx, ny+1, colr, colg, colb, 223);
+		blendpixel(nx, ny-1, colr, colg, colb, 223);
+
+		blendpixel(nx+1, ny-1, colr, colg, colb, 112);
+		blendpixel(nx-1, ny-1, colr, colg, colb, 112);
+		blendpixel(nx+1, ny+1, colr, colg, colb, 112);
+		blendpixel(nx-1, ny+1, colr, colg, colb, 112);
+	}
+	if(pixel_mode & PMODE_GLOW)
+	{
+		int cola1 = (5*cola)/255;
+		addpixel(nx, ny, colr, colg, colb, (192*cola)/255);
+		addpixel(nx+1, ny, colr, colg, colb, (96*cola)/255);
+		addpixel(nx-1, ny, colr, colg, colb, (96*cola)/255);
+		addpixel(nx, ny+1, colr, colg, colb, (96*cola)/255);
+		addpixel(nx, ny-1, colr, colg, colb, (96*cola)/255);
+
+		for (x = 1; x < 6; x++) {
+			addpixel(nx, ny-x, colr, colg, colb, cola1);
+			addpixel(nx, ny+x, colr, colg, colb, cola1);
+			addpixel(nx-x, ny, colr, colg, colb, cola1);
+			addpixel(nx+x, ny, colr, colg, colb, cola1);
+			for (y = 1; y < 6; y++) {
+				if(x + y > 7)
+					continue;
+				addpixel(nx+x, ny-y, colr, colg, colb, cola1);
+				addpixel(nx-x, ny+y, colr, colg, colb, cola1);
+				addpixel(nx+x, ny+y, colr, colg, colb, cola1);
+				addpixel(nx-x, ny-y, colr, colg, colb, cola1);
+			}
+		}
+	}
+	if(pixel_mode & PMODE_BLUR)
+	{
+		for (x=-3; x<4; x++)
+		{
+			for (y=-3; y<4; y++)
+			{
+				if (abs(x)+abs(y) <2 && !(abs(x)==2||abs(y)==2))
+					blendpixel(x+nx, y+ny, colr, colg, colb, 30);
+				if (abs(x)+abs(y) <=3 && abs(x)+abs(y))
+					blendpixel(x+nx, y+ny, colr, colg, colb, 20);
+				if (abs(x)+abs(y) == 2)
+					blendpixel(x+nx, y+ny, colr, colg, colb, 10);
+			}
+		}
+	}
+	if(pixel_mode & PMODE_SPARK)
+	{
+		flicker = part.sparkFlicker;
+		gradv = 4*sim->parts[i].life + flicker;
+		for (x = 0; gradv>0.5; x++) {
+			addpixel(nx+x, ny, colr, colg, colb, int(gradv));
+			addpixel(nx-x, ny, colr, colg, colb, int(gradv));
+
+			addpixel(nx, ny+x, colr, colg, colb, int(gradv));
+			addpixel(nx, ny-x, colr, colg, colb, int(gradv));
+			gradv = gradv/1.5f;
+		}
+	}
+	if(pixel_mode & PMODE_FLARE)
+	{
+		flicker = part.flareFlicker;
+		gradv = flicker + fabs(parts[i].vx)*17 + fabs(sim->parts[i].vy)*17;
+		blendpixel(nx, ny, colr, colg, colb, int((gradv*4)>255?255:(gradv*4)) );
+		blendpixel(nx+1, ny, colr, colg, colb,int( (gradv*2)>255?255:(gradv*2)) );
+		blendpixel(nx-1, ny, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
+		blendpixel(nx, ny+1, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
+		blendpixel(nx, ny-1, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
+		if (gradv>255) gradv=255;
+		blendpixel(nx+1, ny-1, colr, colg, colb, int(gradv));
+		blendpixel(nx-1, ny-1, colr, colg, colb, int(gradv));
+		blendpixel(nx+1, ny+1, colr, colg, colb, int(gradv));
+		blendpixel(nx-1, ny+1, colr, colg, colb, int(gradv));
+		for (x = 1; gradv>0.5; x++) {
+			addpixel(nx+x, ny, colr, colg, colb, int(gradv));
+			addpixel(nx-x, ny, colr, colg, colb, int(gradv));
+			addpixel(nx, ny+x, colr, colg, colb, int(gradv));
+			addpixel(nx, ny-x, colr, colg, colb, int(gradv));
+			gradv = gradv/1.2f;
+		}
+	}
+	if(pixel_mode & PMODE_LFLARE)
+	{
+		flicker = part.lflareFlicker;
+		gradv = flicker + fabs(parts[i].vx)*17 + fabs(parts[i].vy)*17;
+		blendpixel(nx, ny, colr, colg, colb, int((gradv*4)>255?255:(gradv*4)) );
+		blendpixel(nx+1, ny, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
+		blendpixel(nx-1, ny, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
+		blendpixel(nx, ny+1, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
+		blendpixel(nx, ny-1, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
+		if (gradv>255) gradv=255;
+		blendpixel(nx+1, ny-1, colr, colg, colb, int(gradv));
+		blendpixel(nx-1, ny-1, colr, colg, colb, int(gradv));
+		blendpixel(nx+1, ny+1, colr, colg, colb, int(gradv));
+		blendpixel(nx-1, ny+1, colr, colg, colb, int(gradv));
+		for (x = 1; gradv>0.5; x++) {
+			addpixel(nx+x, ny, colr, colg, colb, int(gradv));
+			addpixel(nx-x, ny, colr, colg, colb, int(gradv));
+			addpixel(nx, ny+x, colr, colg, colb, int(gradv));
+			addpixel(nx, ny-x, colr, colg, colb, int(gradv));
+			gradv = gradv/1.01f;
+		}
+	}
+	if (pixel_mode & EFFECT_GRAVIN)
+	{
+		int nxo = 0;
+		int nyo = 0;
+		int r;
+		float drad = 0.0f;
+		float ddist = 0.0f;
+		sim->orbitalparts_get(parts[i].life, parts[i].ctype, orbd, orbl);
+		for (r = 0; r < 4; r++) {
+			ddist = ((float)orbd[r])/16.0f;
+			drad = (M_PI * ((float)orbl[r]) / 180.0f)*1.41f;
+			nxo = (int)(ddist*cos(drad));
+			nyo = (int)(ddist*sin(drad));
+			if (ny+nyo>0 && ny+nyo<YRES && nx+nxo>0 && nx+nxo<XRES && TYP(sim->pmap[ny+nyo][nx+nxo]) != PT_PRTI)
+				addpixel(nx+nxo, ny+nyo, colr, colg, colb, 255-orbd[r]);
+		}
+	}
+	if (pixel_mode & EFFECT_GRAVOUT)
+	{
+		int nxo = 0;
+		int nyo = 0;
+		int r;
+		float drad = 0.0f;
+		float ddist = 0.0f;
+		sim->orbitalparts_get(parts[i].life, parts[i].ctype, orbd, orbl);
+		for (r = 0; r < 4; r++) {
+			ddist = ((float)orbd[r])/16.0f;
+			drad = (M_PI * ((float)orbl[r]) / 180.0f)*1.41f;
+			nxo = (int)(ddist*cos(drad));
+			nyo = (int)(ddist*sin(drad));
+			if (ny+nyo>0 && ny+nyo<YRES && nx+nxo>0 && nx+nxo<XRES && TYP(sim->pmap[ny+nyo][nx+nxo]) != PT_PRTO)
+				addpixel(nx+nxo, ny+nyo, colr, colg, colb, 255-orbd[r]);
+		}
+	}
+	if (pixel_mode & EFFECT_DBGLINES && !(display_mode&DISPLAY_PERS))
+	{
+		// draw lines connecting wifi/portal channels
+		if (mousePos.X == nx && mousePos.Y == ny && i == ID(sim->pmap[ny][nx]) && debugLines)
+		{
+			int type = parts[i].type, tmp = (int)((parts[i].temp-73.15f)/100+1), othertmp;
+			if (type == PT_PRTI)
+				type = PT_PRTO;
+			else if (type == PT_PRTO)
+				type = PT_PRTI;
+			for (int z = 0; z <= sim->parts_lastActiveIndex; z++)
+			{
+				if (parts[z].type == type)
+				{
+					othertmp = (int)((parts[z].temp-73.15f)/100+1);
+					if (tmp == othertmp)
+						xor_line(nx,ny,(int)(parts[z].x+0.5f),(int)(parts[z].y+0.5f));
+				}
+			}
+		}
+	}
+}
+
+// A rectangle containing every pixel draw_part can draw for part
+void Renderer::part_bounds(const PartRender & part, int & x1, int & y1, int & x2, int & y2)
+{
+	int i = part.i, nx = part.nx, ny = part.ny, pixel_mode = part.pixel_mode, reach = 0;
+	Particle * parts = sim->parts;
+	// stickmen and portal lines are few and can be drawn anywhere
+	bool anywhere = pixel_mode & PSPEC_STICKMAN;
+	if (pixel_mode & EFFECT_DBGLINES && !(display_mode&DISPLAY_PERS))
+		anywhere |= mousePos.X == nx && mousePos.Y == ny && i == ID(sim->pmap[ny][nx]) && debugLines;
+	if (anywhere)
+	{
+		x1 = y1 = 0;
+		x2 = VIDXRES-1;
+		y2 = VIDYRES-1;
+		return;
+	}
+	if (pixel_mode & PMODE_BLOB)
+		reach = 1;
+	if (pixel_mode & PMODE_BLUR)
+		reach = std::max(reach, 3);
+	if (pixel_mode & PMODE_GLOW)
+		reach = std::max(reach, 5);
+	if (pixel_mode & (EFFECT_GRAVIN | EFFECT_GRAVOUT))
+		reach = std::max(reach, 16);
+	if (pixel_mode & PMODE_SPARK)
+		reach = std::max(reach, rayReach(4*parts[i].life + part.sparkFlicker, 1.5f));
+	if (pixel_mode & PMODE_FLARE)
+	{
+		float gradv = part.flareFlicker + fabs(parts[i].vx)*17 + fabs(parts[i].vy)*17;
+		reach = std::max(reach, std::max(1, rayReach(std::min(gradv, 255.0f), 1.2f)));
+	}
+	if (pixel_mode & PMODE_LFLARE)
+	{
+		float gradv = part.lflareFlicker + fabs(parts[i].vx)*17 + fabs(parts[i].vy)*17;
+		reach = std::max(reach, std::max(1, rayReach(std::min(gradv, 255.0f), 1.01f)));
+	}
+	x1 = nx - reach;
+	y1 = ny - reach;
+	x2 = nx + reach;
+	y2 = ny + reach;
+	if (pixel_mode & EFFECT_LINES && parts[i].type == PT_SOAP && (parts[i].ctype&3) == 3 && parts[i].tmp >= 0 && parts[i].tmp < NPART)
+	{
+		int lx = (int)(parts[parts[i].tmp].x+0.5f), ly = (int)(parts[parts[i].tmp].y+0.5f);
+		x1 = std::min(x1, lx);
+		y1 = std::min(y1, ly);
+		x2 = std::max(x2, lx);
+		y2 = std::max(y2, ly);
+	}
+	x1 = std::max(x1, 0);
+	y1 = std::max(y1, 0);
+	x2 = std::min(x2, VIDXRES-1);
+	y2 = std::min(y2, VIDYRES-1);
+}
+
+// Draws tileParts on tileThreads threads, which take tiles of the screen in
+// turn. Each tile draws the parts reaching into it in order and clipped to
+// the tile, so no two threads touch the same pixel and every pixel gets the
+// same draws in the same order as it does when the parts are drawn in turn.
+void Renderer::draw_tiles()
+{
+	const int tilesX = (VIDXRES+RENDERER_TILE-1)/RENDERER_TILE;
+	const int tilesY = (VIDYRES+RENDERER_TILE-1)/RENDERER_TILE;
+	if (tilePool.GetThreads() != tileThreads)
+		tilePool.SetThreads(tileThreads);
+	tileBins.resize(tilesX*tilesY);
+	for (auto &bin : tileBins)
+		bin.clear();
+	for (int p = 0; p < int(tileParts.size()); p++)
+	{
+		int x1, y1, x2, y2;
+		part_bounds(tileParts[p], x1, y1, x2, y2);
+		for (int ty = y1/RENDERER_TILE; ty <= y2/RENDERER_TILE; ty++)
+			for (int tx = x1/RENDERER_TILE; tx <= x2/RENDERER_TILE; tx++)
+				tileBins[ty*tilesX+tx].push_back(p);
+	}
+
+	std::atomic<int> nextTile(0);
+	tilePool.ParallelFor(tilePool.GetThreads(), [this, tilesX, &nextTile](int, int) {
+		int tile;
+		while ((tile = nextTile++) < int(tileBins.size()))
+		{
+			int x = tile%tilesX*RENDERER_TILE, y = tile/tilesX*RENDERER_TILE;
+			drawClip = { x, y, std::min(x+RENDERER_TILE, VIDXRES), std::min(y+RENDERER_TILE, VIDYRES) };
+			for (int p : tileBins[tile])
+				draw_part(tileParts[p]);
+		}
+		drawClip = { 0, 0, VIDXRES, VIDYRES };
+	});
+	tileParts.clear();
+}
+#endif
+
+void Renderer::render_parts()
+{
+	int firea, firer, fireg, fireb, pixel_mode, i, nx, ny;
+	PartRender part;
 	if(!sim)
 		return;
-	parts = sim->parts;
-	elements = sim->elements.data();
+	SimulationTimings::Scope scope(sim->timings, SimulationTimings::PHASE_RENDER);
 #ifdef OGLR
-	float fnx, fny;
+	Particle * parts = sim->parts;
+	int cola, colr, colg, colb, t;
+	int orbd[4] = {0, 0, 0, 0}, orbl[4] = {0, 0, 0, 0};
+	float fnx, fny, flicker;
 	int cfireV = 0, cfireC = 0, cfire = 0;
 	int csmokeV = 0, csmokeC = 0, csmoke = 0;
 	int cblobV = 0, cblobC = 0, cblob = 0;
@@ -1241,875 +2101,428 @@ void Renderer::render_parts()
 #endif
 	foundElements = 0;
 	for(i = 0; i<=sim->parts_lastActiveIndex; i++) {
-		if (sim->parts[i].type && sim->parts[i].type >= 0 && sim->parts[i].type < PT_NUM) {
-			t = sim->parts[i].type;
-
-			nx = (int)(sim->parts[i].x+0.5f);
-			ny = (int)(sim->parts[i].y+0.5f);
+		if (!prepare_part(i, part))
+			continue;
+		nx = part.nx;
+		ny = part.ny;
+		pixel_mode = part.pixel_mode;
+		firea = part.firea;
+		firer = part.firer;
+		fireg = part.fireg;
+		fireb = part.fireb;
 #ifdef OGLR
-			fnx = sim->parts[i].x;
-			fny = sim->parts[i].y;
-#endif
-
-			if(nx >= XRES || nx < 0 || ny >= YRES || ny < 0)
-				continue;
-			if(TYP(sim->photons[ny][nx]) && !(sim->elements[t].Properties & TYPE_ENERGY) && t!=PT_STKM && t!=PT_STKM2 && t!=PT_FIGH)
-				continue;
-
-			//Defaults
-			pixel_mode = 0 | PMODE_FLAT;
-			cola = 255;
-			colr = PIXR(elements[t].Colour);
-			colg = PIXG(elements[t].Colour);
-			colb = PIXB(elements[t].Colour);
-			firer = fireg = fireb = firea = 0;
-
-			deca = (sim->parts[i].dcolour>>24)&0xFF;
-			decr = (sim->parts[i].dcolour>>16)&0xFF;
-			decg = (sim->parts[i].dcolour>>8)&0xFF;
-			decb = (sim->parts[i].dcolour)&0xFF;
-
-			if(decorations_enable && blackDecorations)
+		t = sim->parts[i].type;
+		cola = part.cola;
+		colr = part.colr;
+		colg = part.colg;
+		colb = part.colb;
+		fnx = sim->parts[i].x;
+		fny = sim->parts[i].y;
+		if (pixel_mode & EFFECT_LINES)
+		{
+			if (t==PT_SOAP)
 			{
-				if(deca < 250 || decr > 5 || decg > 5 || decb > 5)
-					deca = 0;
-				else
-				{
-					deca = 255;
-					decr = decg = decb = 0;
-				}
+				if ((parts[i].ctype&3) == 3 && parts[i].tmp >= 0 && parts[i].tmp < NPART)
+					draw_line(nx, ny, (int)(parts[parts[i].tmp].x+0.5f), (int)(parts[parts[i].tmp].y+0.5f), colr, colg, colb, cola);
 			}
-
+		}
+		if(pixel_mode & PSPEC_STICKMAN)
+		{
+			playerst *cplayer = part.cplayer;
+			if (mousePos.X>(nx-3) && mousePos.X<(nx+3) && mousePos.Y<(ny+3) && mousePos.Y>(ny-3)) //If mouse is in the head
 			{
-				if (graphicscache[t].isready)
-				{
-					pixel_mode = graphicscache[t].pixel_mode;
-					cola = graphicscache[t].cola;
-					colr = graphicscache[t].colr;
-					colg = graphicscache[t].colg;
-					colb = graphicscache[t].colb;
-					firea = graphicscache[t].firea;
-					firer = graphicscache[t].firer;
-					fireg = graphicscache[t].fireg;
-					fireb = graphicscache[t].fireb;
-				}
-				else if(!(colour_mode & COLOUR_BASC))
-				{
-					if (elements[t].Graphics)
-					{
-#if !defined(RENDERER) && defined(LUACONSOLE)
-						if (lua_gr_func[t])
-						{
-							if (luacon_graphicsReplacement(this, &(sim->parts[i]), nx, ny, &pixel_mode, &cola, &colr, &colg, &colb, &firea, &firer, &fireg, &fireb, i))
-							{
-								graphicscache[t].isready = 1;
-								graphicscache[t].pixel_mode = pixel_mode;
-								graphicscache[t].cola = cola;
-								graphicscache[t].colr = colr;
-								graphicscache[t].colg = colg;
-								graphicscache[t].colb = colb;
-								graphicscache[t].firea = firea;
-								graphicscache[t].firer = firer;
-								graphicscache[t].fireg = fireg;
-								graphicscache[t].fireb = fireb;
-							}
-						}
-						else if ((*(elements[t].Graphics))(this, &(sim->parts[i]), nx, ny, &pixel_mode, &cola, &colr, &colg, &colb, &firea, &firer, &fireg, &fireb)) //That's a lot of args, a struct might be better
-#else
-						if ((*(elements[t].Graphics))(this, &(sim->parts[i]), nx, ny, &pixel_mode, &cola, &colr, &colg, &colb, &firea, &firer, &fireg, &fireb)) //That's a lot of args, a struct might be better
-#endif
-						{
-							graphicscache[t].isready = 1;
-							graphicscache[t].pixel_mode = pixel_mode;
-							graphicscache[t].cola = cola;
-							graphicscache[t].colr = colr;
-							graphicscache[t].colg = colg;
-							graphicscache[t].colb = colb;
-							graphicscache[t].firea = firea;
-							graphicscache[t].firer = firer;
-							graphicscache[t].fireg = fireg;
-							graphicscache[t].fireb = fireb;
-						}
-					}
-					else
-					{
-						graphicscache[t].isready = 1;
-						graphicscache[t].pixel_mode = pixel_mode;
-						graphicscache[t].cola = cola;
-						graphicscache[t].colr = colr;
-						graphicscache[t].colg = colg;
-						graphicscache[t].colb = colb;
-						graphicscache[t].firea = firea;
-						graphicscache[t].firer = firer;
-						graphicscache[t].fireg = fireg;
-						graphicscache[t].fireb = fireb;
-					}
-				}
-				if((elements[t].Properties & PROP_HOT_GLOW) && sim->parts[i].temp>(elements[t].HighTemperature-800.0f))
-				{
-					gradv = 3.1415/(2*elements[t].HighTemperature-(elements[t].HighTemperature-800.0f));
-					caddress = int((sim->parts[i].temp>elements[t].HighTemperature)?elements[t].HighTemperature-(elements[t].HighTemperature-800.0f):sim->parts[i].temp-(elements[t].HighTemperature-800.0f));
-					colr += int(sin(gradv*caddress) * 226);
-					colg += int(sin(gradv*caddress*4.55 +3.14) * 34);
-					colb += int(sin(gradv*caddress*2.22 +3.14) * 64);
-				}
-
-				if((pixel_mode & FIRE_ADD) && !(render_mode & FIRE_ADD))
-					pixel_mode |= PMODE_GLOW;
-				if((pixel_mode & FIRE_BLEND) && !(render_mode & FIRE_BLEND))
-					pixel_mode |= PMODE_BLUR;
-				if((pixel_mode & PMODE_BLUR) && !(render_mode & PMODE_BLUR))
-					pixel_mode |= PMODE_FLAT;
-				if((pixel_mode & PMODE_GLOW) && !(render_mode & PMODE_GLOW))
-					pixel_mode |= PMODE_BLEND;
-				if (render_mode & PMODE_BLOB)
-					pixel_mode |= PMODE_BLOB;
-
-				pixel_mode &= render_mode;
-
-				//Alter colour based on display mode
-				if(colour_mode & COLOUR_HEAT)
-				{
-					constexpr float min_temp = MIN_TEMP;
-					constexpr float max_temp = MAX_TEMP;
-					caddress = int(restrict_flt((sim->parts[i].temp - min_temp) / (max_temp - min_temp) * 1024, 0, 1023)) * 3;
-					firea = 255;
-					firer = colr = color_data[caddress];
-					fireg = colg = color_data[caddress+1];
-					fireb = colb = color_data[caddress+2];
-					cola = 255;
-					if(pixel_mode & (FIREMODE | PMODE_GLOW))
-						pixel_mode = (pixel_mode & ~(FIREMODE|PMODE_GLOW)) | PMODE_BLUR;
-					else if ((pixel_mode & (PMODE_BLEND | PMODE_ADD)) == (PMODE_BLEND | PMODE_ADD))
-						pixel_mode = (pixel_mode & ~(PMODE_BLEND|PMODE_ADD)) | PMODE_FLAT;
-					else if (!pixel_mode)
-						pixel_mode |= PMODE_FLAT;
-				}
-				else if(colour_mode & COLOUR_LIFE)
-				{
-					gradv = 0.4f;
-					if (!(sim->parts[i].life<5))
-						q = int(sqrt((float)sim->parts[i].life));
-					else
-						q = sim->parts[i].life;
-					colr = colg = colb = int(sin(gradv*q) * 100 + 128);
-					cola = 255;
-					if(pixel_mode & (FIREMODE | PMODE_GLOW))
-						pixel_mode = (pixel_mode & ~(FIREMODE|PMODE_GLOW)) | PMODE_BLUR;
-					else if ((pixel_mode & (PMODE_BLEND | PMODE_ADD)) == (PMODE_BLEND | PMODE_ADD))
-						pixel_mode = (pixel_mode & ~(PMODE_BLEND|PMODE_ADD)) | PMODE_FLAT;
-					else if (!pixel_mode)
-						pixel_mode |= PMODE_FLAT;
-				}
-				else if(colour_mode & COLOUR_BASC)
-				{
-					colr = PIXR(elements[t].Colour);
-					colg = PIXG(elements[t].Colour);
-					colb = PIXB(elements[t].Colour);
-					pixel_mode = PMODE_FLAT;
-				}
+				String hp = String::Build(Format::Width(sim->parts[i].life, 3));
+				drawtext(mousePos.X-8-2*(sim->parts[i].life<100)-2*(sim->parts[i].life<10), mousePos.Y-12, hp, 255, 255, 255, 255);
+			}
 
-				//Apply decoration colour
-				if(!(colour_mode & ~COLOUR_GRAD) && decorations_enable && deca)
-				{
-					deca++;
-					if(!(pixel_mode & NO_DECO))
-					{
-						colr = (deca*decr + (256-deca)*colr) >> 8;
-						colg = (deca*decg + (256-deca)*colg) >> 8;
-						colb = (deca*decb + (256-deca)*colb) >> 8;
-					}
+			glColor4f(((float)colr)/255.0f, ((float)colg)/255.0f, ((float)colb)/255.0f, 1.0f);
+			glBegin(GL_LINE_STRIP);
+			if(t==PT_FIGH)
+			{
+				glVertex2f(fnx, fny+2);
+				glVertex2f(fnx+2, fny);
+				glVertex2f(fnx, fny-2);
+				glVertex2f(fnx-2, fny);
+				glVertex2f(fnx, fny+2);
+			}
+			else
+			{
+				glVertex2f(fnx-2, fny-2);
+				glVertex2f(fnx+2, fny-2);
+				glVertex2f(fnx+2, fny+2);
+				glVertex2f(fnx-2, fny+2);
+				glVertex2f(fnx-2, fny-2);
+			}
+			glEnd();
+			glBegin(GL_LINES);
 
-					if(pixel_mode & DECO_FIRE)
-					{
-						firer = (deca*decr + (256-deca)*firer) >> 8;
-						fireg = (deca*decg + (256-deca)*fireg) >> 8;
-						fireb = (deca*decb + (256-deca)*fireb) >> 8;
-					}
-				}
+			if (colour_mode!=COLOUR_HEAT)
+			{
+				if (t==PT_STKM2)
+					glColor4f(100.0f/255.0f, 100.0f/255.0f, 1.0f, 1.0f);
+				else
+					glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+			}
 
-				if (colour_mode & COLOUR_GRAD)
-				{
-					auto frequency = 0.05f;
-					auto q = int(sim->parts[i].temp-40);
-					colr = int(sin(frequency*q) * 16 + colr);
-					colg = int(sin(frequency*q) * 16 + colg);
-					colb = int(sin(frequency*q) * 16 + colb);
-					if(pixel_mode & (FIREMODE | PMODE_GLOW)) pixel_mode = (pixel_mode & ~(FIREMODE|PMODE_GLOW)) | PMODE_BLUR;
-				}
+			glVertex2f(nx, ny+3);
+			glVertex2f(cplayer->legs[0], cplayer->legs[1]);
 
-	#ifndef OGLR
-				//All colours are now set, check ranges
-				if(colr>255) colr = 255;
-				else if(colr<0) colr = 0;
-				if(colg>255) colg = 255;
-				else if(colg<0) colg = 0;
-				if(colb>255) colb = 255;
-				else if(colb<0) colb = 0;
-				if(cola>255) cola = 255;
-				else if(cola<0) cola = 0;
-
-				if(firer>255) firer = 255;
-				else if(firer<0) firer = 0;
-				if(fireg>255) fireg = 255;
-				else if(fireg<0) fireg = 0;
-				if(fireb>255) fireb = 255;
-				else if(fireb<0) fireb = 0;
-				if(firea>255) firea = 255;
-				else if(firea<0) firea = 0;
-	#endif
+			glVertex2f(cplayer->legs[0], cplayer->legs[1]);
+			glVertex2f(cplayer->legs[4], cplayer->legs[5]);
 
-				if (findingElement)
-				{
-					if (TYP(findingElement) == parts[i].type &&
-							(parts[i].type != PT_LIFE || (ID(findingElement) == parts[i].ctype)))
-					{
-						colr = firer = 255;
-						colg = fireg = colb = fireb = 0;
-						foundElements++;
-					}
-					else
-					{
-						colr /= 10;
-						colg /= 10;
-						colb /= 10;
-						firer /= 5;
-						fireg /= 5;
-						fireb /= 5;
-					}
-				}
+			glVertex2f(nx, ny+3);
+			glVertex2f(cplayer->legs[8], cplayer->legs[9]);
 
-				//Pixel rendering
-				if (pixel_mode & EFFECT_LINES)
+			glVertex2f(cplayer->legs[8], cplayer->legs[9]);
+			glVertex2f(cplayer->legs[12], cplayer->legs[13]);
+			glEnd();
+		}
+		if(pixel_mode & PMODE_FLAT)
+		{
+			flatV[cflatV++] = nx;
+			flatV[cflatV++] = ny;
+			flatC[cflatC++] = ((float)colr)/255.0f;
+			flatC[cflatC++] = ((float)colg)/255.0f;
+			flatC[cflatC++] = ((float)colb)/255.0f;
+			flatC[cflatC++] = 1.0f;
+			cflat++;
+		}
+		if(pixel_mode & PMODE_BLEND)
+		{
+			flatV[cflatV++] = nx;
+			flatV[cflatV++] = ny;
+			flatC[cflatC++] = ((float)colr)/255.0f;
+			flatC[cflatC++] = ((float)colg)/255.0f;
+			flatC[cflatC++] = ((float)colb)/255.0f;
+			flatC[cflatC++] = ((float)cola)/255.0f;
+			cflat++;
+		}
+		if(pixel_mode & PMODE_ADD)
+		{
+			addV[caddV++] = nx;
+			addV[caddV++] = ny;
+			addC[caddC++] = ((float)colr)/255.0f;
+			addC[caddC++] = ((float)colg)/255.0f;
+			addC[caddC++] = ((float)colb)/255.0f;
+			addC[caddC++] = ((float)cola)/255.0f;
+			cadd++;
+		}
+		if(pixel_mode & PMODE_BLOB)
+		{
+			blobV[cblobV++] = nx;
+			blobV[cblobV++] = ny;
+			blobC[cblobC++] = ((float)colr)/255.0f;
+			blobC[cblobC++] = ((float)colg)/255.0f;
+			blobC[cblobC++] = ((float)colb)/255.0f;
+			blobC[cblobC++] = 1.0f;
+			cblob++;
+		}
+		if(pixel_mode & PMODE_GLOW)
+		{
+				glowV[cglowV++] = nx;
+			glowV[cglowV++] = ny;
+			glowC[cglowC++] = ((float)colr)/255.0f;
+			glowC[cglowC++] = ((float)colg)/255.0f;
+			glowC[cglowC++] = ((float)colb)/255.0f;
+			glowC[cglowC++] = 1.0f;
+			cglow++;
+		}
+		if(pixel_mode & PMODE_BLUR)
+		{
+			blurV[cblurV++] = nx;
+			blurV[cblurV++] = ny;
+			blurC[cblurC++] = ((float)colr)/255.0f;
+			blurC[cblurC++] = ((float)colg)/255.0f;
+			blurC[cblurC++] = ((float)colb)/255.0f;
+			blurC[cblurC++] = 1.0f;
+			cblur++;
+		}
+		if(pixel_mode & PMODE_SPARK)
+		{
+			flicker = part.sparkFlicker;
+			//Oh god, this is awful
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 0.0f;
+			lineV[clineV++] = fnx-5;
+			lineV[clineV++] = fny;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 1.0f - ((float)flicker)/30;
+			lineV[clineV++] = fnx;
+			lineV[clineV++] = fny;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 0.0f;
+			lineV[clineV++] = fnx+5;
+			lineV[clineV++] = fny;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 0.0f;
+			lineV[clineV++] = fnx;
+			lineV[clineV++] = fny-5;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 1.0f - ((float)flicker)/30;
+			lineV[clineV++] = fnx;
+			lineV[clineV++] = fny;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 0.0f;
+			lineV[clineV++] = fnx;
+			lineV[clineV++] = fny+5;
+			cline++;
+		}
+		if(pixel_mode & PMODE_FLARE)
+		{
+			flicker = part.flareFlicker;
+			//Oh god, this is awful
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 0.0f;
+			lineV[clineV++] = fnx-10;
+			lineV[clineV++] = fny;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 1.0f - ((float)flicker)/40;
+			lineV[clineV++] = fnx;
+			lineV[clineV++] = fny;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 0.0f;
+			lineV[clineV++] = fnx+10;
+			lineV[clineV++] = fny;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 0.0f;
+			lineV[clineV++] = fnx;
+			lineV[clineV++] = fny-10;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 1.0f - ((float)flicker)/30;
+			lineV[clineV++] = fnx;
+			lineV[clineV++] = fny;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 0.0f;
+			lineV[clineV++] = fnx;
+			lineV[clineV++] = fny+10;
+			cline++;
+		}
+		if(pixel_mode & PMODE_LFLARE)
+		{
+			flicker = part.lflareFlicker;
+			//Oh god, this is awful
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 0.0f;
+			lineV[clineV++] = fnx-70;
+			lineV[clineV++] = fny;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 1.0f - ((float)flicker)/30;
+			lineV[clineV++] = fnx;
+			lineV[clineV++] = fny;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 0.0f;
+			lineV[clineV++] = fnx+70;
+			lineV[clineV++] = fny;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 0.0f;
+			lineV[clineV++] = fnx;
+			lineV[clineV++] = fny-70;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 1.0f - ((float)flicker)/50;
+			lineV[clineV++] = fnx;
+			lineV[clineV++] = fny;
+			cline++;
+
+			lineC[clineC++] = ((float)colr)/255.0f;
+			lineC[clineC++] = ((float)colg)/255.0f;
+			lineC[clineC++] = ((float)colb)/255.0f;
+			lineC[clineC++] = 0.0f;
+			lineV[clineV++] = fnx;
+			lineV[clineV++] = fny+70;
+			cline++;
+		}
+		if (pixel_mode & EFFECT_GRAVIN)
+		{
+			int nxo = 0;
+			int nyo = 0;
+			int r;
+			float drad = 0.0f;
+			float ddist = 0.0f;
+			sim->orbitalparts_get(parts[i].life, parts[i].ctype, orbd, orbl);
+			for (r = 0; r < 4; r++) {
+				ddist = ((float)orbd[r])/16.0f;
+				drad = (M_PI * ((float)orbl[r]) / 180.0f)*1.41f;
+				nxo = (int)(ddist*cos(drad));
+				nyo = (int)(ddist*sin(drad));
+				if (ny+nyo>0 && ny+nyo<YRES && nx+nxo>0 && nx+nxo<XRES && TYP(sim->pmap[ny+nyo][nx+nxo]) != PT_PRTI)
+					addpixel(nx+nxo, ny+nyo, colr, colg, colb, 255-orbd[r]);
+			}
+		}
+		if (pixel_mode & EFFECT_GRAVOUT)
+		{
+			int nxo = 0;
+			int nyo = 0;
+			int r;
+			float drad = 0.0f;
+			float ddist = 0.0f;
+			sim->orbitalparts_get(parts[i].life, parts[i].ctype, orbd, orbl);
+			for (r = 0; r < 4; r++) {
+				ddist = ((float)orbd[r])/16.0f;
+				drad = (M_PI * ((float)orbl[r]) / 180.0f)*1.41f;
+				nxo = (int)(ddist*cos(drad));
+				nyo = (int)(ddist*sin(drad));
+				if (ny+nyo>0 && ny+nyo<YRES && nx+nxo>0 && nx+nxo<XRES && TYP(sim->pmap[ny+nyo][nx+nxo]) != PT_PRTO)
+					addpixel(nx+nxo, ny+nyo, colr, colg, colb, 255-orbd[r]);
+			}
+		}
+		if (pixel_mode & EFFECT_DBGLINES && !(display_mode&DISPLAY_PERS))
+		{
+			// draw lines connecting wifi/portal channels
+			if (mousePos.X == nx && mousePos.Y == ny && i == ID(sim->pmap[ny][nx]) && debugLines)
+			{
+				int type = parts[i].type, tmp = (int)((parts[i].temp-73.15f)/100+1), othertmp;
+				if (type == PT_PRTI)
+					type = PT_PRTO;
+				else if (type == PT_PRTO)
+					type = PT_PRTI;
+				for (int z = 0; z <= sim->parts_lastActiveIndex; z++)
 				{
-					if (t==PT_SOAP)
+					if (parts[z].type == type)
 					{
-						if ((parts[i].ctype&3) == 3 && parts[i].tmp >= 0 && parts[i].tmp < NPART)
-							draw_line(nx, ny, (int)(parts[parts[i].tmp].x+0.5f), (int)(parts[parts[i].tmp].y+0.5f), colr, colg, colb, cola);
+						othertmp = (int)((parts[z].temp-73.15f)/100+1);
+						if (tmp == othertmp)
+							xor_line(nx,ny,(int)(parts[z].x+0.5f),(int)(parts[z].y+0.5f));
 					}
 				}
-				if(pixel_mode & PSPEC_STICKMAN)
-				{
-					int legr, legg, legb;
-					playerst *cplayer;
-					if(t==PT_STKM)
-						cplayer = &sim->player;
-					else if(t==PT_STKM2)
-						cplayer = &sim->player2;
-					else if (t==PT_FIGH && sim->parts[i].tmp >= 0 && sim->parts[i].tmp < MAX_FIGHTERS)
-						cplayer = &sim->fighters[(unsigned char)sim->parts[i].tmp];
-					else
-						continue;
-
-					if (mousePos.X>(nx-3) && mousePos.X<(nx+3) && mousePos.Y<(ny+3) && mousePos.Y>(ny-3)) //If mouse is in the head
-					{
-						String hp = String::Build(Format::Width(sim->parts[i].life, 3));
-						drawtext(mousePos.X-8-2*(sim->parts[i].life<100)-2*(sim->parts[i].life<10), mousePos.Y-12, hp, 255, 255, 255, 255);
-					}
-
-					if (findingElement == t)
-					{
-						colr = 255;
-						colg = colb = 0;
-					}
-					else if (colour_mode != COLOUR_HEAT)
-					{
-						if (cplayer->fan)
-						{
-							colr = PIXR(0x8080FF);
-							colg = PIXG(0x8080FF);
-							colb = PIXB(0x8080FF);
-						}
-						else if (cplayer->elem < PT_NUM && cplayer->elem > 0)
-						{
-							colr = PIXR(elements[cplayer->elem].Colour);
-							colg = PIXG(elements[cplayer->elem].Colour);
-							colb = PIXB(elements[cplayer->elem].Colour);
-						}
-						else
-						{
-							colr = 0x80;
-							colg = 0x80;
-							colb = 0xFF;
-						}
-					}
-
-#ifdef OGLR
-					glColor4f(((float)colr)/255.0f, ((float)colg)/255.0f, ((float)colb)/255.0f, 1.0f);
-					glBegin(GL_LINE_STRIP);
-					if(t==PT_FIGH)
-					{
-						glVertex2f(fnx, fny+2);
-						glVertex2f(fnx+2, fny);
-						glVertex2f(fnx, fny-2);
-						glVertex2f(fnx-2, fny);
-						glVertex2f(fnx, fny+2);
-					}
-					else
-					{
-						glVertex2f(fnx-2, fny-2);
-						glVertex2f(fnx+2, fny-2);
-						glVertex2f(fnx+2, fny+2);
-						glVertex2f(fnx-2, fny+2);
-						glVertex2f(fnx-2, fny-2);
-					}
-					glEnd();
-					glBegin(GL_LINES);
-
-					if (colour_mode!=COLOUR_HEAT)
-					{
-						if (t==PT_STKM2)
-							glColor4f(100.0f/255.0f, 100.0f/255.0f, 1.0f, 1.0f);
-						else
-							glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-					}
-
-					glVertex2f(nx, ny+3);
-					glVertex2f(cplayer->legs[0], cplayer->legs[1]);
-
-					glVertex2f(cplayer->legs[0], cplayer->legs[1]);
-					glVertex2f(cplayer->legs[4], cplayer->legs[5]);
-
-					glVertex2f(nx, ny+3);
-					glVertex2f(cplayer->legs[8], cplayer->legs[9]);
-
-					glVertex2f(cplayer->legs[8], cplayer->legs[9]);
-					glVertex2f(cplayer->legs[12], cplayer->legs[13]);
-					glEnd();
-#else
-					if (findingElement && findingElement == t)
-					{
-						legr = 255;
-						legg = legb = 0;
-					}
-					else if (colour_mode==COLOUR_HEAT)
-					{
-						legr = colr;
-						legg = colg;
-						legb = colb;
-					}
-					else if (t==PT_STKM2)
-					{
-						legr = 100;
-						legg = 100;
-						legb = 255;
-					}
-					else
-					{
-						legr = 255;
-						legg = 255;
-						legb = 255;
-					}
-
-					if (findingElement && findingElement != t)
-					{
-						colr /= 10;
-						colg /= 10;
-						colb /= 10;
-						legr /= 10;
-						legg /= 10;
-						legb /= 10;
-					}
-
-					//head
-					if(t==PT_FIGH)
-					{
-						draw_line(nx, ny+2, nx+2, ny, colr, colg, colb, 255);
-						draw_line(nx+2, ny, nx, ny-2, colr, colg, colb, 255);
-						draw_line(nx, ny-2, nx-2, ny, colr, colg, colb, 255);
-						draw_line(nx-2, ny, nx, ny+2, colr, colg, colb, 255);
-					}
-					else
-					{
-						draw_line(nx-2, ny+2, nx+2, ny+2, colr, colg, colb, 255);
-						draw_line(nx-2, ny-2, nx+2, ny-2, colr, colg, colb, 255);
-						draw_line(nx-2, ny-2, nx-2, ny+2, colr, colg, colb, 255);
-						draw_line(nx+2, ny-2, nx+2, ny+2, colr, colg, colb, 255);
-					}
-					//legs
-					draw_line(nx, ny+3, int(cplayer->legs[0]), int(cplayer->legs[1]), legr, legg, legb, 255);
-					draw_line(int(cplayer->legs[0]), int(cplayer->legs[1]), int(cplayer->legs[4]), int(cplayer->legs[5]), legr, legg, legb, 255);
-					draw_line(nx, ny+3, int(cplayer->legs[8]), int(cplayer->legs[9]), legr, legg, legb, 255);
-					draw_line(int(cplayer->legs[8]), int(cplayer->legs[9]), int(cplayer->legs[12]), int(cplayer->legs[13]), legr, legg, legb, 255);
-					if (cplayer->rocketBoots)
-					{
-						for (int leg=0; leg<2; leg++)
-						{
-							int nx = int(cplayer->legs[leg*8+4]), ny = int(cplayer->legs[leg*8+5]);
-							int colr = 255, colg = 0, colb = 255;
-							if (((int)(cplayer->comm)&0x04) == 0x04 || (((int)(cplayer->comm)&0x01) == 0x01 && leg==0) || (((int)(cplayer->comm)&0x02) == 0x02 && leg==1))
-								blendpixel(nx, ny, 0, 255, 0, 255);
-							else
-								blendpixel(nx, ny, 255, 0, 0, 255);
-							blendpixel(nx+1, ny, colr, colg, colb, 223);
-							blendpixel(nx-1, ny, colr, colg, colb, 223);
-							blendpixel(nx, ny+1, colr, colg, colb, 223);
-							blendpixel(nx, ny-1, colr, colg, colb, 223);
-
-							blendpixel(nx+1, ny-1, colr, colg, colb, 112);
-							blendpixel(nx-1, ny-1, colr, colg, colb, 112);
-							blendpixel(nx+1, ny+1, colr, colg, colb, 112);
-							blendpixel(nx-1, ny+1, colr, colg, colb, 112);
-						}
-					}
-#endif
-				}
-				if(pixel_mode & PMODE_FLAT)
-				{
-#ifdef OGLR
-					flatV[cflatV++] = nx;
-					flatV[cflatV++] = ny;
-					flatC[cflatC++] = ((float)colr)/255.0f;
-					flatC[cflatC++] = ((float)colg)/255.0f;
-					flatC[cflatC++] = ((float)colb)/255.0f;
-					flatC[cflatC++] = 1.0f;
-					cflat++;
-#else
-					vid[ny*(VIDXRES)+nx] = PIXRGB(colr,colg,colb);
-#endif
-				}
-				if(pixel_mode & PMODE_BLEND)
-				{
-#ifdef OGLR
-					flatV[cflatV++] = nx;
-					flatV[cflatV++] = ny;
-					flatC[cflatC++] = ((float)colr)/255.0f;
-					flatC[cflatC++] = ((float)colg)/255.0f;
-					flatC[cflatC++] = ((float)colb)/255.0f;
-					flatC[cflatC++] = ((float)cola)/255.0f;
-					cflat++;
-#else
-					blendpixel(nx, ny, colr, colg, colb, cola);
-#endif
-				}
-				if(pixel_mode & PMODE_ADD)
-				{
-#ifdef OGLR
-					addV[caddV++] = nx;
-					addV[caddV++] = ny;
-					addC[caddC++] = ((float)colr)/255.0f;
-					addC[caddC++] = ((float)colg)/255.0f;
-					addC[caddC++] = ((float)colb)/255.0f;
-					addC[caddC++] = ((float)cola)/255.0f;
-					cadd++;
+			}
+		}
 #else
-					addpixel(nx, ny, colr, colg, colb, cola);
+		if (tileThreads)
+			tileParts.push_back(part);
+		else
+			draw_part(part);
 #endif
-				}
-				if(pixel_mode & PMODE_BLOB)
-				{
-#ifdef OGLR
-					blobV[cblobV++] = nx;
-					blobV[cblobV++] = ny;
-					blobC[cblobC++] = ((float)colr)/255.0f;
-					blobC[cblobC++] = ((float)colg)/255.0f;
-					blobC[cblobC++] = ((float)colb)/255.0f;
-					blobC[cblobC++] = 1.0f;
-					cblob++;
-#else
-					vid[ny*(VIDXRES)+nx] = PIXRGB(colr,colg,colb);
-
-					blendpixel(nx+1, ny, colr, colg, colb, 223);
-					blendpixel(nx-1, ny, colr, colg, colb, 223);
-					blendpixel(nx, ny+1, colr, colg, colb, 223);
-					blendpixel(nx, ny-1, colr, colg, colb, 223);
 
-					blendpixel(nx+1, ny-1, colr, colg, colb, 112);
-					blendpixel(nx-1, ny-1, colr, colg, colb, 112);
-					blendpixel(nx+1, ny+1, colr, colg, colb, 112);
-					blendpixel(nx-1, ny+1, colr, colg, colb, 112);
-#endif
-				}
-				if(pixel_mode & PMODE_GLOW)
-				{
-					int cola1 = (5*cola)/255;
-#ifdef OGLR
-					glowV[cglowV++] = nx;
-					glowV[cglowV++] = ny;
-					glowC[cglowC++] = ((float)colr)/255.0f;
-					glowC[cglowC++] = ((float)colg)/255.0f;
-					glowC[cglowC++] = ((float)colb)/255.0f;
-					glowC[cglowC++] = 1.0f;
-					cglow++;
-#else
-					addpixel(nx, ny, colr, colg, colb, (192*cola)/255);
-					addpixel(nx+1, ny, colr, colg, colb, (96*cola)/255);
-					addpixel(nx-1, ny, colr, colg, colb, (96*cola)/255);
-					addpixel(nx, ny+1, colr, colg, colb, (96*cola)/255);
-					addpixel(nx, ny-1, colr, colg, colb, (96*cola)/255);
-
-					for (x = 1; x < 6; x++) {
-						addpixel(nx, ny-x, colr, colg, colb, cola1);
-						addpixel(nx, ny+x, colr, colg, colb, cola1);
-						addpixel(nx-x, ny, colr, colg, colb, cola1);
-						addpixel(nx+x, ny, colr, colg, colb, cola1);
-						for (y = 1; y < 6; y++) {
-							if(x + y > 7)
-								continue;
-							addpixel(nx+x, ny-y, colr, colg, colb, cola1);
-							addpixel(nx-x, ny+y, colr, colg, colb, cola1);
-							addpixel(nx+x, ny+y, colr, colg, colb, cola1);
-							addpixel(nx-x, ny-y, colr, colg, colb, cola1);
-						}
-					}
-#endif
-				}
-				if(pixel_mode & PMODE_BLUR)
-				{
-#ifdef OGLR
-					blurV[cblurV++] = nx;
-					blurV[cblurV++] = ny;
-					blurC[cblurC++] = ((float)colr)/255.0f;
-					blurC[cblurC++] = ((float)colg)/255.0f;
-					blurC[cblurC++] = ((float)colb)/255.0f;
-					blurC[cblurC++] = 1.0f;
-					cblur++;
-#else
-					for (x=-3; x<4; x++)
-					{
-						for (y=-3; y<4; y++)
-						{
-							if (abs(x)+abs(y) <2 && !(abs(x)==2||abs(y)==2))
-								blendpixel(x+nx, y+ny, colr, colg, colb, 30);
-							if (abs(x)+abs(y) <=3 && abs(x)+abs(y))
-								blendpixel(x+nx, y+ny, colr, colg, colb, 20);
-							if (abs(x)+abs(y) == 2)
-								blendpixel(x+nx, y+ny, colr, colg, colb, 10);
-						}
-					}
-#endif
-				}
-				if(pixel_mode & PMODE_SPARK)
-				{
-					flicker = float(random_gen()%20);
-#ifdef OGLR
-					//Oh god, this is awful
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 0.0f;
-					lineV[clineV++] = fnx-5;
-					lineV[clineV++] = fny;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 1.0f - ((float)flicker)/30;
-					lineV[clineV++] = fnx;
-					lineV[clineV++] = fny;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 0.0f;
-					lineV[clineV++] = fnx+5;
-					lineV[clineV++] = fny;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 0.0f;
-					lineV[clineV++] = fnx;
-					lineV[clineV++] = fny-5;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 1.0f - ((float)flicker)/30;
-					lineV[clineV++] = fnx;
-					lineV[clineV++] = fny;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 0.0f;
-					lineV[clineV++] = fnx;
-					lineV[clineV++] = fny+5;
-					cline++;
-#else
-					gradv = 4*sim->parts[i].life + flicker;
-					for (x = 0; gradv>0.5; x++) {
-						addpixel(nx+x, ny, colr, colg, colb, int(gradv));
-						addpixel(nx-x, ny, colr, colg, colb, int(gradv));
-
-						addpixel(nx, ny+x, colr, colg, colb, int(gradv));
-						addpixel(nx, ny-x, colr, colg, colb, int(gradv));
-						gradv = gradv/1.5f;
-					}
-#endif
-				}
-				if(pixel_mode & PMODE_FLARE)
-				{
-					flicker = float(random_gen()%20);
-#ifdef OGLR
-					//Oh god, this is awful
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 0.0f;
-					lineV[clineV++] = fnx-10;
-					lineV[clineV++] = fny;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 1.0f - ((float)flicker)/40;
-					lineV[clineV++] = fnx;
-					lineV[clineV++] = fny;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 0.0f;
-					lineV[clineV++] = fnx+10;
-					lineV[clineV++] = fny;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 0.0f;
-					lineV[clineV++] = fnx;
-					lineV[clineV++] = fny-10;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 1.0f - ((float)flicker)/30;
-					lineV[clineV++] = fnx;
-					lineV[clineV++] = fny;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 0.0f;
-					lineV[clineV++] = fnx;
-					lineV[clineV++] = fny+10;
-					cline++;
-#else
-					gradv = flicker + fabs(parts[i].vx)*17 + fabs(sim->parts[i].vy)*17;
-					blendpixel(nx, ny, colr, colg, colb, int((gradv*4)>255?255:(gradv*4)) );
-					blendpixel(nx+1, ny, colr, colg, colb,int( (gradv*2)>255?255:(gradv*2)) );
-					blendpixel(nx-1, ny, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
-					blendpixel(nx, ny+1, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
-					blendpixel(nx, ny-1, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
-					if (gradv>255) gradv=255;
-					blendpixel(nx+1, ny-1, colr, colg, colb, int(gradv));
-					blendpixel(nx-1, ny-1, colr, colg, colb, int(gradv));
-					blendpixel(nx+1, ny+1, colr, colg, colb, int(gradv));
-					blendpixel(nx-1, ny+1, colr, colg, colb, int(gradv));
-					for (x = 1; gradv>0.5; x++) {
-						addpixel(nx+x, ny, colr, colg, colb, int(gradv));
-						addpixel(nx-x, ny, colr, colg, colb, int(gradv));
-						addpixel(nx, ny+x, colr, colg, colb, int(gradv));
-						addpixel(nx, ny-x, colr, colg, colb, int(gradv));
-						gradv = gradv/1.2f;
-					}
-#endif
-				}
-				if(pixel_mode & PMODE_LFLARE)
-				{
-					flicker = float(random_gen()%20);
-#ifdef OGLR
-					//Oh god, this is awful
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 0.0f;
-					lineV[clineV++] = fnx-70;
-					lineV[clineV++] = fny;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 1.0f - ((float)flicker)/30;
-					lineV[clineV++] = fnx;
-					lineV[clineV++] = fny;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 0.0f;
-					lineV[clineV++] = fnx+70;
-					lineV[clineV++] = fny;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 0.0f;
-					lineV[clineV++] = fnx;
-					lineV[clineV++] = fny-70;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 1.0f - ((float)flicker)/50;
-					lineV[clineV++] = fnx;
-					lineV[clineV++] = fny;
-					cline++;
-
-					lineC[clineC++] = ((float)colr)/255.0f;
-					lineC[clineC++] = ((float)colg)/255.0f;
-					lineC[clineC++] = ((float)colb)/255.0f;
-					lineC[clineC++] = 0.0f;
-					lineV[clineV++] = fnx;
-					lineV[clineV++] = fny+70;
-					cline++;
-#else
-					gradv = flicker + fabs(parts[i].vx)*17 + fabs(parts[i].vy)*17;
-					blendpixel(nx, ny, colr, colg, colb, int((gradv*4)>255?255:(gradv*4)) );
-					blendpixel(nx+1, ny, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
-					blendpixel(nx-1, ny, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
-					blendpixel(nx, ny+1, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
-					blendpixel(nx, ny-1, colr, colg, colb, int((gradv*2)>255?255:(gradv*2)) );
-					if (gradv>255) gradv=255;
-					blendpixel(nx+1, ny-1, colr, colg, colb, int(gradv));
-					blendpixel(nx-1, ny-1, colr, colg, colb, int(gradv));
-					blendpixel(nx+1, ny+1, colr, colg, colb, int(gradv));
-					blendpixel(nx-1, ny+1, colr, colg, colb, int(gradv));
-					for (x = 1; gradv>0.5; x++) {
-						addpixel(nx+x, ny, colr, colg, colb, int(gradv));
-						addpixel(nx-x, ny, colr, colg, colb, int(gradv));
-						addpixel(nx, ny+x, colr, colg, colb, int(gradv));
-						addpixel(nx, ny-x, colr, colg, colb, int(gradv));
-						gradv = gradv/1.01f;
-					}
-#endif
-				}
-				if (pixel_mode & EFFECT_GRAVIN)
-				{
-					int nxo = 0;
-					int nyo = 0;
-					int r;
-					float drad = 0.0f;
-					float ddist = 0.0f;
-					sim->orbitalparts_get(parts[i].life, parts[i].ctype, orbd, orbl);
-					for (r = 0; r < 4; r++) {
-						ddist = ((float)orbd[r])/16.0f;
-						drad = (M_PI * ((float)orbl[r]) / 180.0f)*1.41f;
-						nxo = (int)(ddist*cos(drad));
-						nyo = (int)(ddist*sin(drad));
-						if (ny+nyo>0 && ny+nyo<YRES && nx+nxo>0 && nx+nxo<XRES && TYP(sim->pmap[ny+nyo][nx+nxo]) != PT_PRTI)
-							addpixel(nx+nxo, ny+nyo, colr, colg, colb, 255-orbd[r]);
-					}
-				}
-				if (pixel_mode & EFFECT_GRAVOUT)
-				{
-					int nxo = 0;
-					int nyo = 0;
-					int r;
-					float drad = 0.0f;
-					float ddist = 0.0f;
-					sim->orbitalparts_get(parts[i].life, parts[i].ctype, orbd, orbl);
-					for (r = 0; r < 4; r++) {
-						ddist = ((float)orbd[r])/16.0f;
-						drad = (M_PI * ((float)orbl[r]) / 180.0f)*1.41f;
-						nxo = (int)(ddist*cos(drad));
-						nyo = (int)(ddist*sin(drad));
-						if (ny+nyo>0 && ny+nyo<YRES && nx+nxo>0 && nx+nxo<XRES && TYP(sim->pmap[ny+nyo][nx+nxo]) != PT_PRTO)
-							addpixel(nx+nxo, ny+nyo, colr, colg, colb, 255-orbd[r]);
-					}
-				}
-				if (pixel_mode & EFFECT_DBGLINES && !(display_mode&DISPLAY_PERS))
-				{
-					// draw lines connecting wifi/portal channels
-					if (mousePos.X == nx && mousePos.Y == ny && i == ID(sim->pmap[ny][nx]) && debugLines)
-					{
-						int type = parts[i].type, tmp = (int)((parts[i].temp-73.15f)/100+1), othertmp;
-						if (type == PT_PRTI)
-							type = PT_PRTO;
-						else if (type == PT_PRTO)
-							type = PT_PRTI;
-						for (int z = 0; z <= sim->parts_lastActiveIndex; z++)
-						{
-							if (parts[z].type == type)
-							{
-								othertmp = (int)((parts[z].temp-73.15f)/100+1);
-								if (tmp == othertmp)
-									xor_line(nx,ny,(int)(parts[z].x+0.5f),(int)(parts[z].y+0.5f));
-							}
-						}
-					}
-				}
-				//Fire effects
-				if(firea && (pixel_mode & FIRE_BLEND))
-				{
+		//Fire effects
+		if(firea && (pixel_mode & FIRE_BLEND))
+		{
 #ifdef OGLR
-					smokeV[csmokeV++] = nx;
-					smokeV[csmokeV++] = ny;
-					smokeC[csmokeC++] = ((float)firer)/255.0f;
-					smokeC[csmokeC++] = ((float)fireg)/255.0f;
-					smokeC[csmokeC++] = ((float)fireb)/255.0f;
-					smokeC[csmokeC++] = ((float)firea)/255.0f;
-					csmoke++;
+			smokeV[csmokeV++] = nx;
+			smokeV[csmokeV++] = ny;
+			smokeC[csmokeC++] = ((float)firer)/255.0f;
+			smokeC[csmokeC++] = ((float)fireg)/255.0f;
+			smokeC[csmokeC++] = ((float)fireb)/255.0f;
+			smokeC[csmokeC++] = ((float)firea)/255.0f;
+			csmoke++;
 #else
-					firea /= 2;
-					fire_r[ny/CELL][nx/CELL] = (firea*firer + (255-firea)*fire_r[ny/CELL][nx/CELL]) >> 8;
-					fire_g[ny/CELL][nx/CELL] = (firea*fireg + (255-firea)*fire_g[ny/CELL][nx/CELL]) >> 8;
-					fire_b[ny/CELL][nx/CELL] = (firea*fireb + (255-firea)*fire_b[ny/CELL][nx/CELL]) >> 8;
+			firea /= 2;
+			fire_r[ny/CELL][nx/CELL] = (firea*firer + (255-firea)*fire_r[ny/CELL][nx/CELL]) >> 8;
+			fire_g[ny/CELL][nx/CELL] = (firea*fireg + (255-firea)*fire_g[ny/CELL][nx/CELL]) >> 8;
+			fire_b[ny/CELL][nx/CELL] = (firea*fireb + (255-firea)*fire_b[ny/CELL][nx/CELL]) >> 8;
 #endif
-				}
-				if(firea && (pixel_mode & FIRE_ADD))
-				{
+		}
+		if(firea && (pixel_mode & FIRE_ADD))
+		{
 #ifdef OGLR
-					fireV[cfireV++] = nx;
-					fireV[cfireV++] = ny;
-					fireC[cfireC++] = ((float)firer)/255.0f;
-					fireC[cfireC++] = ((float)fireg)/255.0f;
-					fireC[cfireC++] = ((float)fireb)/255.0f;
-					fireC[cfireC++] = ((float)firea)/255.0f;
-					cfire++;
+			fireV[cfireV++] = nx;
+			fireV[cfireV++] = ny;
+			fireC[cfireC++] = ((float)firer)/255.0f;
+			fireC[cfireC++] = ((float)fireg)/255.0f;
+			fireC[cfireC++] = ((float)fireb)/255.0f;
+			fireC[cfireC++] = ((float)firea)/255.0f;
+			cfire++;
 #else
-					firea /= 8;
-					firer = ((firea*firer) >> 8) + fire_r[ny/CELL][nx/CELL];
-					fireg = ((firea*fireg) >> 8) + fire_g[ny/CELL][nx/CELL];
-					fireb = ((firea*fireb) >> 8) + fire_b[ny/CELL][nx/CELL];
-
-					if(firer>255)
-						firer = 255;
-					if(fireg>255)
-						fireg = 255;
-					if(fireb>255)
-						fireb = 255;
-
-					fire_r[ny/CELL][nx/CELL] = firer;
-					fire_g[ny/CELL][nx/CELL] = fireg;
-					fire_b[ny/CELL][nx/CELL] = fireb;
+			firea /= 8;
+			firer = ((firea*firer) >> 8) + fire_r[ny/CELL][nx/CELL];
+			fireg = ((firea*fireg) >> 8) + fire_g[ny/CELL][nx/CELL];
+			fireb = ((firea*fireb) >> 8) + fire_b[ny/CELL][nx/CELL];
+
+			if(firer>255)
+				firer = 255;
+			if(fireg>255)
+				fireg = 255;
+			if(fireb>255)
+				fireb = 255;
+
+			fire_r[ny/CELL][nx/CELL] = firer;
+			fire_g[ny/CELL][nx/CELL] = fireg;
+			fire_b[ny/CELL][nx/CELL] = fireb;
 #endif
-				}
-				if(firea && (pixel_mode & FIRE_SPARK))
-				{
+		}
+		if(firea && (pixel_mode & FIRE_SPARK))
+		{
 #ifdef OGLR
-					smokeV[csmokeV++] = nx;
-					smokeV[csmokeV++] = ny;
-					smokeC[csmokeC++] = ((float)firer)/255.0f;
-					smokeC[csmokeC++] = ((float)fireg)/255.0f;
-					smokeC[csmokeC++] = ((float)fireb)/255.0f;
-					smokeC[csmokeC++] = ((float)firea)/255.0f;
-					csmoke++;
+			smokeV[csmokeV++] = nx;
+			smokeV[csmokeV++] = ny;
+			smokeC[csmokeC++] = ((float)firer)/255.0f;
+			smokeC[csmokeC++] = ((float)fireg)/255.0f;
+			smokeC[csmokeC++] = ((float)fireb)/255.0f;
+			smokeC[csmokeC++] = ((float)firea)/255.0f;
+			csmoke++;
 #else
-					firea /= 4;
-					fire_r[ny/CELL][nx/CELL] = (firea*firer + (255-firea)*fire_r[ny/CELL][nx/CELL]) >> 8;
-					fire_g[ny/CELL][nx/CELL] = (firea*fireg + (255-firea)*fire_g[ny/CELL][nx/CELL]) >> 8;
-					fire_b[ny/CELL][nx/CELL] = (firea*fireb + (255-firea)*fire_b[ny/CELL][nx/CELL]) >> 8;
+			firea /= 4;
+			fire_r[ny/CELL][nx/CELL] = (firea*firer + (255-firea)*fire_r[ny/CELL][nx/CELL]) >> 8;
+			fire_g[ny/CELL][nx/CELL] = (firea*fireg + (255-firea)*fire_g[ny/CELL][nx/CELL]) >> 8;
+			fire_b[ny/CELL][nx/CELL] = (firea*fireb + (255-firea)*fire_b[ny/CELL][nx/CELL]) >> 8;
 #endif
-				}
-			}
 		}
 	}
+#ifndef OGLR
+	if (tileThreads)
+		draw_tiles();
+#endif
 #ifdef OGLR
 
 		//Go into array mode
@@ -2579,7 +2992,15 @@ Renderer::Renderer(Graphics * g, Simulation * sim):
 	zoomScopeSize(32),
 	zoomEnabled(false),
 	ZFACTOR(8),
-	gridSize(0)
+	gridSize(0),
+	rng(&random_gen),
+	liveRng(nullptr),
+	pipelined(false),
+	pipelineFrameReady(false),
+	pipelineVid(nullptr),
+	liveSim(nullptr),
+	liveVid(nullptr),
+	tileThreads(0)
 {
 	this->g = g;
 	this->sim = sim;
@@ -2592,6 +3013,9 @@ Renderer::Renderer(Graphics * g, Simulation * sim):
 	persistentVid = new pixel[VIDXRES*YRES];
 	warpVid = new pixel[VIDXRES*VIDYRES];
 #endif
+#ifndef OGLI
+	pipelineVid = new pixel[VIDXRES*VIDYRES];
+#endif
 
 	memset(fire_r, 0, sizeof(fire_r));
 	memset(fire_g, 0, sizeof(fire_g));
@@ -2979,6 +3403,9 @@ VideoBuffer Renderer::DumpFrame()
 
 Renderer::~Renderer()
 {
+	if (pipelineThread.joinable())
+		pipelineThread.join();
+	delete[] pipelineVid;
 #if !defined(OGLR)
 #if defined(OGLI)
 	delete[] vid;
@@ -2,16 +2,21 @@
 #define RENDERER_H
 #include "Config.h"
 
+#include <memory>
+#include <thread>
 #include <vector>
 #ifdef OGLR
 #include "OpenGLHeaders.h"
 #endif
 
 #include "Graphics.h"
+#include "common/ThreadPool.h"
+#include "common/tpt-rand.h"
 #include "gui/interface/Point.h"
 
 class RenderPreset;
 class Simulation;
+struct playerst;
 
 struct gcache_item
 {
@@ -97,6 +102,34 @@ public:
 	void clearScreen(float alpha);
 	void SetSample(int x, int y);
 
+	// Pipelined rendering, software renderer only. RenderBeginPipelined copies
+	// what RenderBegin reads from the simulation and renders that copy on
+	// another thread while the caller simulates the next frame, so the frame
+	// shown lags the simulation by one. RenderWaitPipelined must be called
+	// before anything else touches the renderer, then PresentPipelined puts
+	// the frame on screen in place of clearScreen and RenderBegin. Both Begin
+	// and Present return false if they did nothing.
+	void SetPipelined(bool pipelined) { this->pipelined = pipelined; }
+	bool GetPipelined() { return pipelined; }
+	bool RenderBeginPipelined();
+	void RenderWaitPipelined();
+	bool PresentPipelined();
+
+	// Tile rendering, software renderer only. With threads above 0,
+	// render_parts works out how every particle is drawn before drawing any,
+	// then splits the screen into tiles that the threads draw separately, each
+	// with the particles that reach into it in their usual order, so the frame
+	// is the same as when they are drawn one at a time, as they are with 0.
+	void SetTileThreads(int threads) { tileThreads = threads; }
+	int GetTileThreads() { return tileThreads; }
+
+	// fire flicker is drawn from random_gen, renderers used on other threads
+	// should give each thread its own generator
+	void SetRNG(RNG * newRng) { rng = newRng; }
+	// Lua graphics functions have to run on the thread that owns the Lua
+	// state, one at a time
+	static bool LuaGraphicsInUse();
+
 #ifdef OGLR
 	void checkShader(GLuint shader, const char * shname);
 	void checkProgram(GLuint program, const char * progname);
@@ -166,6 +199,44 @@ public:
 
 private:
 	int gridSize;
+
+	// fire flicker, drawn from pipelineRng on the render thread
+	RNG * rng;
+	RNG * liveRng;
+	bool pipelined;
+	bool pipelineFrameReady;
+	std::unique_ptr<Simulation> pipelineSim;
+	pixel * pipelineVid;
+	RNG pipelineRng;
+	std::thread pipelineThread;
+	// swapped out for pipelineSim, pipelineVid and pipelineRng while the thread renders
+	Simulation * liveSim;
+	pixel * liveVid;
+
+	// how render_parts draws a particle, worked out before anything is drawn
+	struct PartRender
+	{
+		int i, nx, ny;
+		int pixel_mode;
+		int cola, colr, colg, colb;
+		int firea, firer, fireg, fireb;
+		// stickmen only
+		playerst * cplayer;
+		int legr, legg, legb;
+		float sparkFlicker, flareFlicker, lflareFlicker;
+	};
+	bool prepare_part(int i, PartRender & part);
+#ifndef OGLR
+	void draw_part(const PartRender & part);
+	void part_bounds(const PartRender & part, int & x1, int & y1, int & x2, int & y2);
+	void draw_tiles();
+#endif
+
+	int tileThreads;
+	ThreadPool tilePool;
+	std::vector<PartRender> tileParts;
+	// indices into tileParts of the ones reaching into each tile, in order
+	std::vector<std::vector<int>> tileBins;
 #ifdef OGLR
 	GLuint zoomTex, airBuf, fireAlpha, glowAlpha, blurAlpha, partsFboTex, partsFbo, partsTFX, partsTFY, airPV, airVY, airVX;
 	GLuint fireProg, airProg_Pressure, airProg_Velocity, airProg_Cracker, lensProg;
@@ -5,6 +5,7 @@
 #include "client/Client.h"
 #include "client/GameSave.h"
 #include "client/SaveFile.h"
+#include "client/ThumbnailCache.h"
 #include "common/Platform.h"
 #include "graphics/Graphics.h"
 #include "gui/Style.h"
@@ -147,6 +148,7 @@ void FileBrowserActivity::DeleteSave(SaveFile * file)
 	if (ConfirmPrompt::Blocking("Delete Save", deleteMessage))
 	{
 		remove(file->GetName().c_str());
+		ThumbnailCache::Invalidate(file->GetName());
 		loadDirectory(directory, "");
 	}
 }
@@ -161,7 +163,10 @@ void FileBrowserActivity::RenameSave(SaveFile * file)
 		if (ret)
 			ErrorMessage::Blocking("Error", "Could not rename file");
 		else
+		{
+			ThumbnailCache::Invalidate(file->GetName());
 			loadDirectory(directory, "");
+		}
 	}
 	else
 		ErrorMessage::Blocking("Error", "No save name given");
@@ -13,6 +13,8 @@
 #include "RenderPreset.h"
 #include "Tool.h"
 
+#include <chrono>
+
 #ifdef LUACONSOLE
 # include "lua/LuaScriptInterface.h"
 # include "lua/LuaEvents.h"
@@ -27,6 +29,7 @@
 #include "debug/DebugLines.h"
 #include "debug/DebugParts.h"
 #include "debug/ElementPopulation.h"
+#include "debug/ElementTiming.h"
 #include "debug/ParticleDebug.h"
 #include "graphics/Renderer.h"
 #include "simulation/Air.h"
@@ -83,6 +86,7 @@ GameController::GameController():
 	localBrowser(NULL),
 	options(NULL),
 	debugFlags(0),
+	framesSimulated(0),
 	HasDone(false)
 {
 	gameView = new GameView();
@@ -106,6 +110,7 @@ GameController::GameController():
 	debugInfo.push_back(new ElementPopulationDebug(0x2, gameModel->GetSimulation()));
 	debugInfo.push_back(new DebugLines(0x4, gameView, this));
 	debugInfo.push_back(new ParticleDebug(0x8, gameModel->GetSimulation(), gameModel, this));
+	debugInfo.push_back(new ElementTimingDebug(0x10, gameModel->GetSimulation()));
 }
 
 GameController::~GameController()
@@ -146,12 +151,6 @@ GameController::~GameController()
 	{
 		delete *iter;
 	}
-	//deleted here because it refuses to be deleted when deleted from gameModel even with the same code
-	std::deque<Snapshot*> history = gameModel->GetHistory();
-	for(std::deque<Snapshot*>::iterator iter = history.begin(), end = history.end(); iter != end; ++iter)
-	{
-		delete *iter;
-	}
 	std::vector<QuickOption*> quickOptions = gameModel->GetQuickOptions();
 	for(std::vector<QuickOption*>::iterator iter = quickOptions.begin(), end = quickOptions.end(); iter != end; ++iter)
 	{
@@ -171,14 +170,14 @@ GameController::~GameController()
 
 void GameController::HistoryRestore()
 {
-	std::deque<Snapshot*> history = gameModel->GetHistory();
-	if (!history.size())
+	size_t historySize = gameModel->GetHistorySize();
+	if (!historySize)
 		return;
 	unsigned int historyPosition = gameModel->GetHistoryPosition();
 	unsigned int newHistoryPosition = std::max((int)historyPosition-1, 0);
 	// When undoing, save the current state as a final redo
 	// This way ctrl+y will always bring you back to the point right before your last ctrl+z
-	if (historyPosition == history.size())
+	if (historyPosition == historySize)
 	{
 		Snapshot * newSnap = gameModel->GetSimulation()->CreateSnapshot();
 		if (newSnap)
@@ -186,38 +185,21 @@ void GameController::HistoryRestore()
 		delete gameModel->GetRedoHistory();
 		gameModel->SetRedoHistory(newSnap);
 	}
-	Snapshot * snap = history[newHistoryPosition];
+	Snapshot * snap = gameModel->GetHistory(newHistoryPosition);
+	if (!snap)
+		return;
 	gameModel->GetSimulation()->Restore(*snap);
 	Client::Ref().OverwriteAuthorInfo(snap->Authors);
-	gameModel->SetHistory(history);
 	gameModel->SetHistoryPosition(newHistoryPosition);
 }
 
 void GameController::HistorySnapshot()
 {
-	std::deque<Snapshot*> history = gameModel->GetHistory();
-	unsigned int historyPosition = gameModel->GetHistoryPosition();
 	Snapshot * newSnap = gameModel->GetSimulation()->CreateSnapshot();
 	if (newSnap)
 	{
 		newSnap->Authors = Client::Ref().GetAuthorInfo();
-		while (historyPosition < history.size())
-		{
-			Snapshot * snap = history.back();
-			history.pop_back();
-			delete snap;
-		}
-		if (history.size() >= gameModel->GetUndoHistoryLimit())
-		{
-			Snapshot * snap = history.front();
-			history.pop_front();
-			delete snap;
-			if (historyPosition > history.size())
-				historyPosition--;
-		}
-		history.push_back(newSnap);
-		gameModel->SetHistory(history);
-		gameModel->SetHistoryPosition(std::min((size_t)historyPosition+1, history.size()));
+		gameModel->PushHistory(newSnap);
 		delete gameModel->GetRedoHistory();
 		gameModel->SetRedoHistory(NULL);
 	}
@@ -225,16 +207,16 @@ void GameController::HistorySnapshot()
 
 void GameController::HistoryForward()
 {
-	std::deque<Snapshot*> history = gameModel->GetHistory();
-	if (!history.size())
+	size_t historySize = gameModel->GetHistorySize();
+	if (!historySize)
 		return;
 	unsigned int historyPosition = gameModel->GetHistoryPosition();
-	unsigned int newHistoryPosition = std::min((size_t)historyPosition+1, history.size());
+	unsigned int newHistoryPosition = std::min((size_t)historyPosition+1, historySize);
 	Snapshot *snap;
-	if (newHistoryPosition == history.size())
+	if (newHistoryPosition == historySize)
 		snap = gameModel->GetRedoHistory();
 	else
-		snap = history[newHistoryPosition];
+		snap = gameModel->GetHistory(newHistoryPosition);
 	if (!snap)
 		return;
 	gameModel->GetSimulation()->Restore(*snap);
@@ -949,22 +931,40 @@ void GameController::LoadRenderPreset(int presetNum)
 void GameController::Update()
 {
 	Simulation * sim = gameModel->GetSimulation();
+	Renderer * ren = gameModel->GetRenderer();
 
-	if (!sim->sys_pause || sim->framerender)
-	{
-		if (GetAutoreloadEnabled() && sim->needReloadParticleOrder)
+	ui::Point pos = gameView->GetMousePosition();
+	ren->mousePos = PointTranslate(pos);
+	// renders this frame while the next one is simulated, GameView presents it
+	ren->RenderBeginPipelined();
+
+	// in turbo mode, keep simulating until ticksPerFrame frames are done, or
+	// with ticksPerFrame 0 until the time a frame has at the FPS limit is up;
+	// stepping single frames while paused is unaffected
+	int ticksPerFrame = gameModel->GetTicksPerFrame();
+	float fpsLimit = ui::Engine::Ref().FpsLimit;
+	auto frameEnd = std::chrono::steady_clock::now() + std::chrono::microseconds(int(1000000 / (fpsLimit > 2 ? fpsLimit : 60)));
+	framesSimulated = 0;
+	do
+	{
+		if (!sim->sys_pause || sim->framerender)
 		{
-			ReloadParticleOrder();
+			if (GetAutoreloadEnabled() && sim->needReloadParticleOrder)
+			{
+				ReloadParticleOrder();
+			}
 		}
-	}
 
-	sim->BeforeSim();
-	if (!sim->sys_pause || sim->framerender)
-	{
-		sim->UpdateParticles(0, NPART);
-		sim->AfterSim();
-		sim->subframe_mode = false;
+		sim->BeforeSim();
+		if (!sim->sys_pause || sim->framerender)
+		{
+			sim->UpdateParticles(0, NPART);
+			sim->AfterSim();
+			sim->subframe_mode = false;
+			framesSimulated++;
+		}
 	}
+	while (!sim->sys_pause && (ticksPerFrame ? framesSimulated < ticksPerFrame : std::chrono::steady_clock::now() < frameEnd));
 	if (sim->subframe_mode)
 	{
 		for (std::vector<DebugInfo*>::iterator iter = debugInfo.begin(), end = debugInfo.end(); iter != end; iter++)
@@ -973,9 +973,8 @@ void GameController::Update()
 				((ParticleDebug*)*iter)->Debug(0xf, 0, 0);
 		}
 	}
+	ren->RenderWaitPipelined();
 
-	ui::Point pos = gameView->GetMousePosition();
-	gameModel->GetRenderer()->mousePos = PointTranslate(pos);
 	if (pos.X < XRES && pos.Y < YRES)
 		sim->UpdateSample(PointTranslate(pos).X, PointTranslate(pos).Y);
 	else
@@ -1137,6 +1136,17 @@ void GameController::SetDebugHUD(bool hudState)
 	gameView->SetDebugHUD(hudState);
 }
 
+void GameController::SetDebugFlags(unsigned int flags)
+{
+	debugFlags = flags;
+	// timing every particle update isn't free, only do it while the panel is shown
+	SimulationTimings &timings = gameModel->GetSimulation()->timings;
+	bool elementTiming = flags & 0x10;
+	if (elementTiming && !timings.elementsEnabled)
+		timings.ResetElements();
+	timings.elementsEnabled = elementTiming;
+}
+
 bool GameController::GetDebugHUD()
 {
 	return gameView->GetDebugHUD();
@@ -56,6 +56,7 @@ private:
 	std::vector<DebugInfo*> debugInfo;
 	unsigned int debugFlags;
 	bool autoreloadEnabled;
+	int framesSimulated;
 	
 	void OpenSaveDone();
 public:
@@ -116,9 +117,11 @@ public:
 	void SetDebugHUD(bool hudState);
 	bool GetDebugHUD();
 	bool GetParticleDebugEnabled() { return debugFlags & 0x8; }
-	void SetDebugFlags(unsigned int flags) { debugFlags = flags; }
+	void SetDebugFlags(unsigned int flags);
 	bool GetAutoreloadEnabled() { return autoreloadEnabled; }
 	void SetAutoreloadEnabled(bool e) { autoreloadEnabled = e; }
+	// simulation frames run by the last Update
+	int GetFramesSimulated() { return framesSimulated; }
 	void SetActiveMenu(int menuID);
 	std::vector<Menu*> GetMenuList();
 	int GetNumMenus(bool onlyEnabled);
@@ -26,6 +26,7 @@
 #include "simulation/Gravity.h"
 #include "simulation/Simulation.h"
 #include "simulation/Snapshot.h"
+#include "simulation/SnapshotDelta.h"
 #include "simulation/ElementClasses.h"
 #include "simulation/ElementGraphics.h"
 #include "simulation/ToolClasses.h"
@@ -42,6 +43,7 @@ GameModel::GameModel():
 	currentFile(NULL),
 	currentUser(0, ""),
 	toolStrength(1.0f),
+	historyCurrentIndex(0),
 	wasModified(false),
 	redoHistory(NULL),
 	historyPosition(0),
@@ -50,7 +52,8 @@ GameModel::GameModel():
 	colour(255, 0, 0, 255),
 	edgeMode(0),
 	ambientAirTemp(R_TEMP + 273.15f),
-	decoSpace(0)
+	decoSpace(0),
+	ticksPerFrame(1)
 {
 	sim = new Simulation();
 	ren = new Renderer(ui::Engine::Ref().g, sim);
@@ -91,10 +94,13 @@ GameModel::GameModel():
 
 	ren->gravityFieldEnabled = Client::Ref().GetPrefBool("Renderer.GravityField", false);
 	ren->decorations_enable = Client::Ref().GetPrefBool("Renderer.Decorations", true);
+	ren->SetPipelined(Client::Ref().GetPrefBool("Renderer.Pipelined", false));
+	ren->SetTileThreads(std::min(std::max(Client::Ref().GetPrefInteger("Renderer.TileThreads", 0), 0), 64));
 
 	//Load config into simulation
 	edgeMode = Client::Ref().GetPrefInteger("Simulation.EdgeMode", 0);
 	sim->SetEdgeMode(edgeMode);
+	ticksPerFrame = Client::Ref().GetPrefInteger("Simulation.TicksPerFrame", 1);
 	ambientAirTemp = float(R_TEMP) + 273.15f;
 	{
 		auto temp = Client::Ref().GetPrefNumber("Simulation.AmbientAirTemp", ambientAirTemp);
@@ -111,6 +117,9 @@ GameModel::GameModel():
 		sim->grav->start_grav_async();
 	sim->aheat_enable =  Client::Ref().GetPrefInteger("Simulation.AmbientHeat", 0);
 	sim->pretty_powder =  Client::Ref().GetPrefInteger("Simulation.PrettyPowder", 0);
+	sim->air->SetThreads(std::min(std::max(Client::Ref().GetPrefInteger("Simulation.AirThreads", 1), 1), 64));
+	sim->SetParallelHeat(std::min(std::max(Client::Ref().GetPrefInteger("Simulation.ParallelHeat", 0), 0), 64));
+	sim->SetChunkSleep(Client::Ref().GetPrefBool("Simulation.ChunkSleep", false));
 
 	Favorite::Ref().LoadFavoritesFromPrefs();
 
@@ -142,10 +151,7 @@ GameModel::GameModel():
 	colourPresets.push_back(ui::Colour(0, 0, 255));
 	colourPresets.push_back(ui::Colour(0, 0, 0));
 
-	undoHistoryLimit = Client::Ref().GetPrefInteger("Simulation.UndoHistoryLimit", 5);
-	// cap due to memory usage (this is about 3.4GB of RAM)
-	if (undoHistoryLimit > 200)
-		SetUndoHistoryLimit(200);
+	undoHistoryBudget = Client::Ref().GetPrefInteger("Simulation.UndoHistoryBudget", 100);
 
 	mouseClickRequired = Client::Ref().GetPrefBool("MouseClickRequired", false);
 	includePressure = Client::Ref().GetPrefBool("Simulation.IncludePressure", true);
@@ -166,6 +172,7 @@ GameModel::~GameModel()
 
 	Client::Ref().SetPref("Renderer.GravityField", (bool)ren->gravityFieldEnabled);
 	Client::Ref().SetPref("Renderer.Decorations", (bool)ren->decorations_enable);
+	Client::Ref().SetPref("Renderer.Pipelined", ren->GetPipelined());
 	Client::Ref().SetPref("Renderer.DebugMode", ren->debugLines); //These two should always be equivalent, even though they are different things
 
 	Client::Ref().SetPref("Simulation.NewtonianGravity", sim->grav->IsEnabled());
@@ -540,6 +547,16 @@ int GameModel::GetEdgeMode()
 	return this->edgeMode;
 }
 
+void GameModel::SetTicksPerFrame(int ticksPerFrame)
+{
+	this->ticksPerFrame = ticksPerFrame;
+}
+
+int GameModel::GetTicksPerFrame()
+{
+	return ticksPerFrame;
+}
+
 void GameModel::SetAmbientAirTemperature(float ambientAirTemp)
 {
 	this->ambientAirTemp = ambientAirTemp;
@@ -562,19 +579,91 @@ int GameModel::GetDecoSpace()
 	return this->decoSpace;
 }
 
-std::deque<Snapshot*> GameModel::GetHistory()
+size_t GameModel::GetHistorySize()
 {
-	return history;
+	return history.size();
 }
 
-unsigned int GameModel::GetHistoryPosition()
+Snapshot * GameModel::GetHistory(unsigned int index)
 {
-	return historyPosition;
+	if (index + 1 == history.size())
+		return history.back().snap.get();
+	// walk from the newest entry instead if that is fewer steps
+	if (!historyCurrent || (index > historyCurrentIndex && history.size() - 1 - index < index - historyCurrentIndex))
+	{
+		historyCurrentIndex = history.size() - 2;
+		historyCurrent = history[historyCurrentIndex].delta->Restore(*history.back().snap);
+	}
+	// a damaged delta leaves historyCurrent empty, which the next call starts over from
+	while (historyCurrent && historyCurrentIndex > index)
+	{
+		historyCurrentIndex--;
+		historyCurrent = history[historyCurrentIndex].delta->Restore(*historyCurrent);
+	}
+	while (historyCurrent && historyCurrentIndex < index)
+	{
+		historyCurrent = history[historyCurrentIndex].delta->Forward(*historyCurrent);
+		historyCurrentIndex++;
+	}
+	return historyCurrent.get();
+}
+
+void GameModel::PushHistory(Snapshot * snap)
+{
+	std::unique_ptr<Snapshot> newest(snap);
+	if (historyPosition < history.size())
+	{
+		// the entry before the position becomes the newest again, so it needs its whole snapshot back
+		std::unique_ptr<Snapshot> previous;
+		if (historyPosition > 0)
+		{
+			Snapshot * previousSnap = GetHistory(historyPosition - 1);
+			if (previousSnap)
+				previous.reset(new Snapshot(*previousSnap));
+		}
+		history.erase(history.begin() + historyPosition, history.end());
+		if (previous)
+		{
+			history.back().delta.reset();
+			history.back().snap = std::move(previous);
+		}
+		else
+		{
+			// without that snapshot none of the older entries can be rebuilt
+			history.clear();
+		}
+	}
+	historyCurrent.reset();
+	if (history.size())
+	{
+		HistoryEntry &previous = history.back();
+		previous.delta = SnapshotDelta::FromSnapshots(*previous.snap, *newest);
+		previous.snap.reset();
+	}
+	history.push_back(HistoryEntry());
+	history.back().snap = std::move(newest);
+	historyPosition = history.size();
+
+	// drop the oldest entries until the rest fit, but always keep the newest one
+	size_t budget = size_t(undoHistoryBudget) * 1024 * 1024;
+	std::vector<size_t> sizes;
+	size_t size = 0;
+	for (auto &entry : history)
+	{
+		sizes.push_back(entry.snap ? entry.snap->Size() : entry.delta->GetSize());
+		size += sizes.back();
+	}
+	for (size_t i = 0; history.size() > 1 && size > budget; i++)
+	{
+		size -= sizes[i];
+		history.pop_front();
+		historyPosition--;
+	}
 }
 
-void GameModel::SetHistory(std::deque<Snapshot*> newHistory)
+unsigned int GameModel::GetHistoryPosition()
 {
-	history = newHistory;
+	return historyPosition;
 }
 
 void GameModel::SetHistoryPosition(unsigned int newHistoryPosition)
@@ -592,15 +681,15 @@ void GameModel::SetRedoHistory(Snapshot * redo)
 	redoHistory = redo;
 }
 
-unsigned int GameModel::GetUndoHistoryLimit()
+unsigned int GameModel::GetUndoHistoryBudget()
 {
-	return undoHistoryLimit;
+	return undoHistoryBudget;
 }
 
-void GameModel::SetUndoHistoryLimit(unsigned int undoHistoryLimit_)
+void GameModel::SetUndoHistoryBudget(unsigned int undoHistoryBudget_)
 {
-	undoHistoryLimit = undoHistoryLimit_;
-	Client::Ref().SetPref("Simulation.UndoHistoryLimit", undoHistoryLimit);
+	undoHistoryBudget = undoHistoryBudget_;
+	Client::Ref().SetPref("Simulation.UndoHistoryBudget", undoHistoryBudget);
 }
 
 void GameModel::SetVote(int direction)
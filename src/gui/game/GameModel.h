@@ -4,6 +4,7 @@
 
 #include <vector>
 #include <deque>
+#include <memory>
 
 #include "gui/interface/Colour.h"
 #include "client/User.h"
@@ -21,6 +22,7 @@ class SaveFile;
 class Simulation;
 class Renderer;
 class Snapshot;
+class SnapshotDelta;
 class GameSave;
 
 class ToolSelection
@@ -32,6 +34,14 @@ public:
 	};
 };
 
+struct HistoryEntry
+{
+	// only the newest entry keeps a whole snapshot, every other one keeps
+	// the delta between it and the entry after it
+	std::unique_ptr<Snapshot> snap;
+	std::unique_ptr<SnapshotDelta> delta;
+};
+
 class GameModel
 {
 private:
@@ -65,11 +75,15 @@ private:
 	Tool * configToolset[4];
 	User currentUser;
 	float toolStrength;
-	std::deque<Snapshot*> history;
+	std::deque<HistoryEntry> history;
+	// whole snapshot of history[historyCurrentIndex], kept so stepping
+	// through the history only applies one delta at a time
+	std::unique_ptr<Snapshot> historyCurrent;
+	unsigned int historyCurrentIndex;
 	bool wasModified;
 	Snapshot *redoHistory;
 	unsigned int historyPosition;
-	unsigned int undoHistoryLimit;
+	unsigned int undoHistoryBudget;
 	bool mouseClickRequired;
 	bool includePressure;
 	bool perfectCircle = true;
@@ -82,6 +96,7 @@ private:
 	int edgeMode;
 	float ambientAirTemp;
 	int decoSpace;
+	int ticksPerFrame;
 
 	String infoTip;
 	String toolTip;
@@ -115,6 +130,10 @@ public:
 
 	void SetEdgeMode(int edgeMode);
 	int GetEdgeMode();
+	// simulation frames run for each frame drawn, 0 for as many as fit in
+	// the time a frame has at the FPS limit
+	void SetTicksPerFrame(int ticksPerFrame);
+	int GetTicksPerFrame();
 	void SetAmbientAirTemperature(float ambientAirTemp);
 	float GetAmbientAirTemperature();
 	void SetDecoSpace(int decoSpace);
@@ -143,14 +162,18 @@ public:
 	void BuildBrushList();
 	void BuildQuickOptionMenu(GameController * controller);
 
-	std::deque<Snapshot*> GetHistory();
+	size_t GetHistorySize();
+	// the snapshot at index, valid until the history next changes
+	Snapshot * GetHistory(unsigned int index);
+	// drops everything after the current position and adds snap, taking ownership of it
+	void PushHistory(Snapshot * snap);
 	unsigned int GetHistoryPosition();
-	void SetHistory(std::deque<Snapshot*> newHistory);
 	void SetHistoryPosition(unsigned int newHistoryPosition);
 	Snapshot * GetRedoHistory();
 	void SetRedoHistory(Snapshot * redo);
-	unsigned int GetUndoHistoryLimit();
-	void SetUndoHistoryLimit(unsigned int undoHistoryLimit_);
+	// in megabytes
+	unsigned int GetUndoHistoryBudget();
+	void SetUndoHistoryBudget(unsigned int undoHistoryBudget_);
 
 	void UpdateQuickOptions();
 
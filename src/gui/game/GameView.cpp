@@ -20,6 +20,7 @@
 #include "client/Client.h"
 #include "common/Platform.h"
 #include "graphics/Graphics.h"
+#include "graphics/Recording.h"
 #include "graphics/Renderer.h"
 #include "gui/Style.h"
 #include "simulation/ElementClasses.h"
@@ -197,6 +198,7 @@ GameView::GameView():
 	screenshotIndex(0),
 	recording(false),
 	recordingFolder(0),
+	recorder(NULL),
 	recordingSubframe(false),
 	recordInterval(1),
 	recordIntervalIndex(0),
@@ -371,6 +373,7 @@ GameView::~GameView()
 	}
 
 	delete placeSaveThumb;
+	delete recorder;
 }
 
 class GameView::OptionListener: public QuickOptionListener
@@ -927,6 +930,9 @@ int GameView::Record(bool record, bool subframe)
 	{
 		recording = false;
 		recordingFolder = 0;
+		// waits for the writer thread to catch up
+		delete recorder;
+		recorder = NULL;
 		recordingSubframe = false;
 		recordIntervalIndex = 0;
 	}
@@ -947,6 +953,7 @@ int GameView::Record(bool record, bool subframe)
 			recordingFolder = startTime;
 			Platform::MakeDirectory("recordings");
 			Platform::MakeDirectory(ByteString::Build("recordings", PATH_SEP, recordingFolder).c_str());
+			recorder = new RecordingWriter(ByteString::Build("recordings", PATH_SEP, recordingFolder, PATH_SEP, "frames.tptrec"), XRES, YRES);
 			recording = true;
 			recordIntervalIndex = 0;
 
@@ -1632,7 +1639,7 @@ void GameView::OnFileDrop(ByteString filename)
 		return;
 	}
 
-	SaveFile *saveFile = Client::Ref().LoadSaveFile(filename);
+	SaveFile *saveFile = Client::Ref().LoadSaveFile(filename, false);
 	if (!saveFile)
 		return;
 	if (saveFile->GetError().length())
@@ -2117,8 +2124,11 @@ void GameView::OnDraw()
 	Graphics * g = GetGraphics();
 	if (ren)
 	{
-		ren->clearScreen(1.0f);
-		ren->RenderBegin();
+		if (!ren->PresentPipelined())
+		{
+			ren->clearScreen(1.0f);
+			ren->RenderBegin();
+		}
 		ren->SetSample(c->PointTranslate(currentMouse).X, c->PointTranslate(currentMouse).Y);
 		if (showBrush && selectMode == SelectNone && (!zoomEnabled || zoomCursorFixed) && activeBrush && (isMouseDown || (currentMouse.X >= 0 && currentMouse.X < XRES && currentMouse.Y >= 0 && currentMouse.Y < YRES)))
 		{
@@ -2246,12 +2256,21 @@ void GameView::OnDraw()
 
 		if (recording && recordIntervalIndex == 0)
 		{
+			// encoding and writing happen on the recorder's thread, use
+			// recording-export to turn the recording into images
 			VideoBuffer screenshot(ren->DumpFrame());
-			std::vector<char> data = format::VideoBufferToPPM(screenshot);
-
-			ByteString filename = ByteString::Build("recordings", PATH_SEP, recordingFolder, PATH_SEP, "frame_", Format::Width(screenshotIndex++, 6), ".ppm");
+			recorder->AddFrame(std::vector<pixel>(screenshot.Buffer, screenshot.Buffer + XRES * YRES));
+			screenshotIndex++;
+		}
 
-			Client::Ref().WriteFile(data, filename);
+		if (recording && recorder->Failed())
+		{
+			// the disk filled up or the file couldn't be created, frames after
+			// the last one written are lost, so stop rather than carry on silently
+			String filename = ByteString::Build("recordings", PATH_SEP, recordingFolder, PATH_SEP, "frames.tptrec").FromUtf8();
+			int framesWritten = recorder->GetFramesWritten();
+			Record(false);
+			new ErrorMessage("Recording stopped", String::Build("Could not write to ", filename, ", only the first ", framesWritten, " frames were saved."));
 		}
 
 		if (recording)
@@ -2533,6 +2552,8 @@ void GameView::OnDraw()
 			else
 				fpsInfo << " Parts: " << sample.NumParts;
 		}
+		if (c->GetFramesSimulated() > 1)
+			fpsInfo << " [Turbo: " << c->GetFramesSimulated() << "x]";
 		if (c->GetParticleDebugPosition() != 0)
 			fpsInfo << " [Subf: #" << c->GetParticleDebugPosition() << "]";
 		if (c->GetStackEditDepth() >= 0)
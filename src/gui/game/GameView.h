@@ -33,6 +33,7 @@ class SplitButton;
 class MenuButton;
 class Renderer;
 class VideoBuffer;
+class RecordingWriter;
 class ToolButton;
 class GameController;
 class Brush;
@@ -78,6 +79,7 @@ private:
 	int screenshotIndex;
 	bool recording;
 	int recordingFolder;
+	RecordingWriter * recorder;
 	bool recordingSubframe;
 	int recordInterval;
 	int recordIntervalIndex;
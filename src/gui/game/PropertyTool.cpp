@@ -356,6 +356,7 @@ void PropertyTool::SetProperty(Simulation *sim, ui::Point position)
 		default:
 			break;
 	}
+	sim->InvalidateStackIndex();
 }
 
 void PropertyTool::Draw(Simulation *sim, Brush *cBrush, ui::Point position)
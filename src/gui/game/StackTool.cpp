@@ -21,6 +21,14 @@ static bool compareParts(Particle a, Particle b)
 	else return a.y < b.y;
 }
 
+static void addStack(Simulation *sim, std::vector<int> &parts, int x, int y)
+{
+	if (x < 0 || x >= XRES || y < 0 || y >= YRES)
+		return;
+	for (int i = sim->StackIndexHead(x, y); i >= 0; i = sim->stackIndexNext[i])
+		parts.push_back(i);
+}
+
 // parts must be sorted!
 void StackTool::ProcessParts(Simulation *sim, std::vector<int> &parts, ui::Point position)
 {
@@ -89,6 +97,7 @@ void StackTool::ProcessParts(Simulation *sim, std::vector<int> &parts, ui::Point
 		}
 		delete partobjs;
 	}
+	sim->InvalidateStackIndex();
 }
 
 void StackTool::Draw(Simulation *sim, Brush *cBrush, ui::Point position)
@@ -98,18 +107,11 @@ void StackTool::Draw(Simulation *sim, Brush *cBrush, ui::Point position)
 		std::vector<int> parts;
 		int radiusX = cBrush->GetRadius().X, radiusY = cBrush->GetRadius().Y, sizeX = cBrush->GetSize().X, sizeY = cBrush->GetSize().Y;
 		unsigned char *bitmap = cBrush->GetBitmap();
-		for (int i=0; i<=sim->parts_lastActiveIndex; i++)
-		{
-			if (sim->parts[i].type)
-			{
-				int partx = (int)(sim->parts[i].x+0.5f);
-				int party = (int)(sim->parts[i].y+0.5f);
-				int partbmpx = partx - position.X + radiusX;
-				int partbmpy = party - position.Y + radiusY;
-				if (partbmpx >= 0 && partbmpx < sizeX && partbmpy >= 0 && partbmpy < sizeY && bitmap[partbmpy * sizeX + partbmpx])
-					parts.push_back(i);
-			}
-		}
+		for (int y = 0; y < sizeY; y++)
+			for (int x = 0; x < sizeX; x++)
+				if (bitmap[y * sizeX + x])
+					addStack(sim, parts, position.X - radiusX + x, position.Y - radiusY + y);
+		std::sort(parts.begin(), parts.end());
 		ProcessParts(sim, parts, position);
 	}
 }
@@ -168,19 +170,11 @@ void StackTool::DrawLine(Simulation *sim, Brush *cBrush, ui::Point position, ui:
 		}
 	}
 	std::sort(points.begin(), points.end(), comparePoints);
+	points.erase(std::unique(points.begin(), points.end()), points.end());
 	std::vector<int> parts;
-	for (int i=0; i<=sim->parts_lastActiveIndex; i++)
-	{
-		if (sim->parts[i].type)
-		{
-			int partx = (int)(sim->parts[i].x+0.5f);
-			int party = (int)(sim->parts[i].y+0.5f);
-			ui::Point partpos(partx, party);
-			std::vector<ui::Point>::iterator it = std::lower_bound(points.begin(), points.end(), partpos, comparePoints);
-			if (it != points.end() && *it == partpos)
-				parts.push_back(i);
-		}
-	}
+	for (size_t i = 0; i < points.size(); i++)
+		addStack(sim, parts, points[i].X, points[i].Y);
+	std::sort(parts.begin(), parts.end());
 	ProcessParts(sim, parts, position);
 }
 
@@ -201,15 +195,9 @@ void StackTool::DrawRect(Simulation *sim, Brush *cBrush, ui::Point position, ui:
 		y1 = j;
 	}
 	std::vector<int> parts;
-	for (int i=0; i<=sim->parts_lastActiveIndex; i++)
-	{
-		if (sim->parts[i].type)
-		{
-			int partx = (int)(sim->parts[i].x+0.5f);
-			int party = (int)(sim->parts[i].y+0.5f);
-			if (partx >= x1 && partx <= x2 && party >= y1 && party <= y2)
-				parts.push_back(i);
-		}
-	}
+	for (int y = std::max(y1, 0); y <= std::min(y2, YRES-1); y++)
+		for (int x = std::max(x1, 0); x <= std::min(x2, XRES-1); x++)
+			addStack(sim, parts, x, y);
+	std::sort(parts.begin(), parts.end());
 	ProcessParts(sim, parts, ui::Point(x1, y1));
 }
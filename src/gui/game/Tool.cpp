@@ -95,6 +95,7 @@ void WallTool::DrawLine(Simulation * sim, Brush * brush, ui::Point position1, ui
 					sim->fvx[j][i] = newFanVelX;
 					sim->fvy[j][i] = newFanVelY;
 					sim->bmap[j][i] = WL_FAN;
+					sim->WakeChunks(i*CELL, j*CELL, i*CELL+CELL-1, j*CELL+CELL-1);
 				}
 	}
 	else
@@ -141,6 +142,7 @@ void WindTool::DrawLine(Simulation * sim, Brush * brush, ui::Point position1, ui
 			}
 		}
 	}
+	sim->WakeChunks(position1.X-radiusX, position1.Y-radiusY, position1.X+radiusX, position1.Y+radiusY);
 }
 
 
@@ -148,6 +148,7 @@ void SaveButton::Tick(float dt)
 			else if (file && file->GetGameSave())
 			{
 				thumbnailRenderer = new ThumbnailRendererTask(file->GetGameSave(), thumbBoxSize.X, thumbBoxSize.Y, true, true, false);
+				thumbnailRenderer->SetCacheFile(file->GetName());
 				thumbnailRenderer->Start();
 				triedThumbnail = true;
 			}
@@ -57,6 +57,11 @@ void OptionsController::SetEdgeMode(int edgeMode)
 	model->SetEdgeMode(edgeMode);
 }
 
+void OptionsController::SetTicksPerFrame(int ticksPerFrame)
+{
+	model->SetTicksPerFrame(ticksPerFrame);
+}
+
 void OptionsController::SetFullscreen(bool fullscreen)
 {
 	model->SetFullscreen(fullscreen);
@@ -24,6 +24,7 @@ public:
 	void SetAirMode(int airMode);
 	void SetAmbientAirTemperature(float ambientAirTemp);
 	void SetEdgeMode(int edgeMode);
+	void SetTicksPerFrame(int ticksPerFrame);
 	void SetFullscreen(bool fullscreen);
 	void SetAltFullscreen(bool altFullscreen);
 	void SetForceIntegerScaling(bool forceIntegerScaling);
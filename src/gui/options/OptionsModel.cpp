@@ -90,6 +90,17 @@ void OptionsModel::SetEdgeMode(int edgeMode)
 	notifySettingsChanged();
 }
 
+int OptionsModel::GetTicksPerFrame()
+{
+	return gModel->GetTicksPerFrame();
+}
+void OptionsModel::SetTicksPerFrame(int ticksPerFrame)
+{
+	Client::Ref().SetPref("Simulation.TicksPerFrame", ticksPerFrame);
+	gModel->SetTicksPerFrame(ticksPerFrame);
+	notifySettingsChanged();
+}
+
 float OptionsModel::GetAmbientAirTemperature()
 {
 	return gModel->GetSimulation()->air->ambientAirTemp;
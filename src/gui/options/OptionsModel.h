@@ -32,6 +32,8 @@ public:
 	void SetAmbientAirTemperature(float ambientAirTemp);
 	int GetEdgeMode();
 	void SetEdgeMode(int edgeMode);
+	int GetTicksPerFrame();
+	void SetTicksPerFrame(int ticksPerFrame);
 	int GetGravityMode();
 	void SetGravityMode(int gravityMode);
 	int GetScale();
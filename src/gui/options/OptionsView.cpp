@@ -163,6 +163,27 @@ OptionsView::OptionsView():
 	tempLabel->Appearance.VerticalAlign = ui::Appearance::AlignMiddle;
 	scrollPanel->AddChild(tempLabel);
 
+	currentY+=20;
+	ticksPerFrame = new ui::DropDown(ui::Point(Size.X-95, currentY), ui::Point(80, 16));
+	scrollPanel->AddChild(ticksPerFrame);
+	ticksPerFrame->AddOption(std::pair<String, int>("Off", 1));
+	for (int ticks = 2; ticks <= 64; ticks *= 2)
+		ticksPerFrame->AddOption(std::pair<String, int>(String::Build(ticks, "x"), ticks));
+	ticksPerFrame->AddOption(std::pair<String, int>("Max", 0));
+	ticksPerFrame->SetActionCallback({ [this] { c->SetTicksPerFrame(ticksPerFrame->GetOption().second); } });
+
+	tempLabel = new ui::Label(ui::Point(8, currentY), ui::Point(Size.X-96, 16), "Turbo Mode");
+	tempLabel->Appearance.HorizontalAlign = ui::Appearance::AlignLeft;
+	tempLabel->Appearance.VerticalAlign = ui::Appearance::AlignMiddle;
+	scrollPanel->AddChild(tempLabel);
+
+	currentY+=14;
+	tempLabel = new ui::Label(ui::Point(24, currentY), ui::Point(1, 16), "\bgSimulates several frames for each one drawn");
+	autowidth(tempLabel);
+	tempLabel->Appearance.HorizontalAlign = ui::Appearance::AlignLeft;
+	tempLabel->Appearance.VerticalAlign = ui::Appearance::AlignMiddle;
+	scrollPanel->AddChild(tempLabel);
+
 	currentY+=20;
 	tmpSeparator = new Separator(ui::Point(0, currentY), ui::Point(Size.X, 1));
 	scrollPanel->AddChild(tmpSeparator);
@@ -434,6 +455,7 @@ void OptionsView::NotifySettingsChanged(OptionsModel * sender)
 	gravityMode->SetOption(sender->GetGravityMode());
 	decoSpace->SetOption(sender->GetDecoSpace());
 	edgeMode->SetOption(sender->GetEdgeMode());
+	ticksPerFrame->SetOption(sender->GetTicksPerFrame());
 	scale->SetOption(sender->GetScale());
 	resizable->SetChecked(sender->GetResizable());
 	fullscreen->SetChecked(sender->GetFullscreen());
@@ -27,6 +27,7 @@ class OptionsView: public ui::Window
 	ui::Button * ambientAirTempPreview;
 	ui::DropDown * gravityMode;
 	ui::DropDown * edgeMode;
+	ui::DropDown * ticksPerFrame;
 	ui::DropDown * scale;
 	ui::Checkbox * resizable;
 	ui::Checkbox * fullscreen;
@@ -4,6 +4,9 @@
 #include <vector>
 #include <algorithm>
 #include <locale>
+#include <atomic>
+#include <unordered_map>
+#include <thread>
 
 #include "Format.h"
 #include "LuaScriptHelper.h"
@@ -123,6 +126,7 @@ int luacon_partwrite(lua_State* l)
 		return luaL_error(l, "Dead particle");
 	if (offset == -1)
 		return luaL_error(l, "Invalid property");
+	luacon_sim->InvalidateStackIndex();
 
 	switch(format)
 	{
@@ -265,6 +269,7 @@ int luacon_elementwrite(lua_State* l)
 	luacon_model->BuildMenus();
 	luacon_sim->init_can_move();
 	std::fill(&luacon_ren->graphicscache[0], &luacon_ren->graphicscache[PT_NUM], gcache_item());
+	luacon_clearGraphicsMemo();
 
 	return 0;
 }
@@ -379,7 +384,78 @@ int luatpt_element_func(lua_State *l)
 	return 0;
 }
 
-int luacon_graphicsReplacement(GRAPHICS_FUNC_ARGS, int i)
+// Results of graphics functions their scripts declared pure, keyed by
+// everything such a function may look at. Temperatures are bucketed to the
+// degree, so a pure function that shades by temperature is only called once
+// per degree, and the memo is emptied when it grows past
+// GRAPHICSMEMO_MAXSIZE rather than tracking which entries are still used.
+// The memo is not locked, so only the thread that owns the Lua state, which
+// is the one declaring functions pure, uses it; thumbnail contexts rendering
+// elsewhere call the function every time.
+#define GRAPHICSMEMO_MAXSIZE 65536
+
+struct GraphicsMemoKey
+{
+	int type, ctype, life, tmp, tmp2, temp;
+	unsigned int dcolour;
+	int colr, colg, colb;
+
+	bool operator ==(const GraphicsMemoKey &other) const
+	{
+		return type == other.type && ctype == other.ctype && life == other.life && tmp == other.tmp && tmp2 == other.tmp2 &&
+			temp == other.temp && dcolour == other.dcolour && colr == other.colr && colg == other.colg && colb == other.colb;
+	}
+};
+
+struct GraphicsMemoKeyHash
+{
+	size_t operator ()(const GraphicsMemoKey &key) const
+	{
+		size_t hash = key.type;
+		for (int field : { key.ctype, key.life, key.tmp, key.tmp2, key.temp, int(key.dcolour), key.colr, key.colg, key.colb })
+			hash = hash * 31 + field;
+		return hash;
+	}
+};
+
+struct GraphicsMemoResult
+{
+	int cache, pixel_mode, cola, colr, colg, colb, firea, firer, fireg, fireb;
+};
+
+static bool graphicsPure[PT_NUM];
+static std::unordered_map<GraphicsMemoKey, GraphicsMemoResult, GraphicsMemoKeyHash> graphicsMemo;
+static std::thread::id graphicsMemoThread;
+
+void luacon_setGraphicsPure(int element, bool pure)
+{
+	graphicsPure[element] = pure;
+	graphicsMemoThread = std::this_thread::get_id();
+	luacon_clearGraphicsMemo();
+}
+
+void luacon_clearGraphicsMemo()
+{
+	graphicsMemo.clear();
+}
+
+static std::atomic<bool> graphicsFuncsInUse(false);
+
+void luacon_graphicsFuncsChanged()
+{
+	bool inUse = false;
+	if (lua_gr_func)
+		for (int t = 0; t < PT_NUM && !inUse; t++)
+			inUse = bool(lua_gr_func[t]);
+	graphicsFuncsInUse = inUse;
+}
+
+bool luacon_graphicsFuncsInUse()
+{
+	return graphicsFuncsInUse;
+}
+
+static int callGraphicsReplacement(GRAPHICS_FUNC_ARGS, int i, bool *failed = nullptr)
 {
 	int cache = 0, callret;
 	lua_rawgeti(luacon_ci->l, LUA_REGISTRYINDEX, lua_gr_func[cpart->type]);
@@ -392,6 +468,8 @@ int luacon_graphicsReplacement(GRAPHICS_FUNC_ARGS, int i)
 	{
 		luacon_ci->Log(CommandInterface::LogError, luacon_geterror());
 		lua_pop(luacon_ci->l, 1);
+		if (failed)
+			*failed = true;
 	}
 	else
 	{
@@ -420,6 +498,49 @@ int luacon_graphicsReplacement(GRAPHICS_FUNC_ARGS, int i)
 	return cache;
 }
 
+int luacon_graphicsReplacement(GRAPHICS_FUNC_ARGS, int i)
+{
+	if (!graphicsPure[cpart->type] || std::this_thread::get_id() != graphicsMemoThread)
+		return callGraphicsReplacement(ren, cpart, nx, ny, pixel_mode, cola, colr, colg, colb, firea, firer, fireg, fireb, i);
+
+	GraphicsMemoKey key = { cpart->type, cpart->ctype, cpart->life, cpart->tmp, cpart->tmp2, int(floorf(cpart->temp)), cpart->dcolour, *colr, *colg, *colb };
+	auto found = graphicsMemo.find(key);
+	if (found == graphicsMemo.end())
+	{
+		GraphicsMemoResult result;
+		bool failed = false;
+		result.cache = callGraphicsReplacement(ren, cpart, nx, ny, pixel_mode, cola, colr, colg, colb, firea, firer, fireg, fireb, i, &failed);
+		// the function may have changed its own purity or been replaced, and
+		// an error is reported again next time rather than remembered
+		if (failed || !graphicsPure[cpart->type])
+			return result.cache;
+		result.pixel_mode = *pixel_mode;
+		result.cola = *cola;
+		result.colr = *colr;
+		result.colg = *colg;
+		result.colb = *colb;
+		result.firea = *firea;
+		result.firer = *firer;
+		result.fireg = *fireg;
+		result.fireb = *fireb;
+		if (graphicsMemo.size() >= GRAPHICSMEMO_MAXSIZE)
+			graphicsMemo.clear();
+		graphicsMemo[key] = result;
+		return result.cache;
+	}
+	const GraphicsMemoResult &result = found->second;
+	*pixel_mode = result.pixel_mode;
+	*cola = result.cola;
+	*colr = result.colr;
+	*colg = result.colg;
+	*colb = result.colb;
+	*firea = result.firea;
+	*firer = result.firer;
+	*fireg = result.fireg;
+	*fireb = result.fireb;
+	return result.cache;
+}
+
 int luatpt_graphics_func(lua_State *l)
 {
 	if(lua_isfunction(l, 1))
@@ -428,6 +549,8 @@ int luatpt_graphics_func(lua_State *l)
 		if (luacon_sim->IsElement(element))
 		{
 			lua_gr_func[element].Assign(l, 1);
+			luacon_graphicsFuncsChanged();
+			luacon_setGraphicsPure(element, lua_toboolean(l, 3));
 			luacon_ren->graphicscache[element].isready = 0;
 			return 0;
 		}
@@ -442,6 +565,8 @@ int luatpt_graphics_func(lua_State *l)
 		if (luacon_sim->IsElement(element))
 		{
 			lua_gr_func[element].Clear();
+			luacon_graphicsFuncsChanged();
+			luacon_setGraphicsPure(element, false);
 			luacon_ren->graphicscache[element].isready = 0;
 			return 0;
 		}
@@ -608,6 +733,7 @@ int luatpt_set_pressure(lua_State* l)
 		{
 			luacon_sim->pv[ny][nx] = value;
 		}
+	luacon_sim->WakeChunks(x1*CELL, y1*CELL, (x1+width)*CELL-1, (y1+height)*CELL-1);
 	return 0;
 }
 
@@ -639,6 +765,7 @@ int luatpt_set_gravity(lua_State* l)
 		{
 			luacon_sim->gravmap[ny*(XRES/CELL)+nx] = value;
 		}
+	luacon_sim->WakeChunks(x1*CELL, y1*CELL, (x1+width)*CELL-1, (y1+height)*CELL-1);
 	return 0;
 }
 
@@ -690,6 +817,7 @@ int luatpt_reset_velocity(lua_State* l)
 			luacon_sim->vx[ny][nx] = 0;
 			luacon_sim->vy[ny][nx] = 0;
 		}
+	luacon_sim->WakeChunks(x1*CELL, y1*CELL, (x1+width)*CELL-1, (y1+height)*CELL-1);
 	return 0;
 }
 
@@ -711,6 +839,7 @@ int luatpt_set_property(lua_State* l)
 	int offset = luacon_ci->GetPropertyOffset(prop, format);
 	if (offset == -1)
 		return luaL_error(l, "Invalid property '%s'", prop);
+	luacon_sim->InvalidateStackIndex();
 
 	if (acount > 2)
 	{
@@ -870,6 +999,7 @@ int luatpt_set_wallmap(lua_State* l)
 			}
 		}
 	}
+	luacon_sim->WakeChunks(x*CELL, y*CELL, (x+w)*CELL-1, (y+h)*CELL-1);
 	return 0;
 }
 
@@ -901,6 +1031,7 @@ int luatpt_set_elecmap(lua_State* l)
 			{
 				luacon_sim->emap[ny][nx] = value;
 			}
+		luacon_sim->WakeChunks(x1*CELL, y1*CELL, (x1+width)*CELL-1, (y1+height)*CELL-1);
 	}
 	else	//Set point
 	{
@@ -909,6 +1040,7 @@ int luatpt_set_elecmap(lua_State* l)
 		if(y1 > (YRES/CELL))
 			y1 = (YRES/CELL);
 		luacon_sim->emap[y1][x1] = value;
+		luacon_sim->WakeChunks(x1*CELL, y1*CELL, x1*CELL+CELL-1, y1*CELL+CELL-1);
 	}
 	return 0;
 }
@@ -53,6 +53,16 @@ int luacon_transitionwrite(lua_State* l);
 int luatpt_getelement(lua_State *l);
 
 int luacon_graphicsReplacement(GRAPHICS_FUNC_ARGS, int i);
+// a pure graphics function only looks at the particle's type, ctype, life,
+// tmp, tmp2, temperature (to the degree) and dcolour, and at the colours it
+// is passed, so its results are memoised on those
+void luacon_setGraphicsPure(int element, bool pure);
+void luacon_clearGraphicsMemo();
+// call on the Lua thread after assigning or clearing any lua_gr_func entry;
+// luacon_graphicsFuncsInUse can then be read from any thread, such as
+// thumbnail renderers deciding whether they may run in parallel
+void luacon_graphicsFuncsChanged();
+bool luacon_graphicsFuncsInUse();
 int luatpt_graphics_func(lua_State *l);
 
 int luacon_elementReplacement(UPDATE_FUNC_ARGS);
@@ -841,6 +841,10 @@ void LuaScriptInterface::initSimulationAPI()
 		{"edgeMode", simulation_edgeMode},
 		{"gravityMode", simulation_gravityMode},
 		{"airMode", simulation_airMode},
+		{"airThreads", simulation_airThreads},
+		{"parallelHeat", simulation_parallelHeat},
+		{"chunkSleep", simulation_chunkSleep},
+		{"ticksPerFrame", simulation_ticksPerFrame},
 		{"waterEqualisation", simulation_waterEqualisation},
 		{"waterEqualization", simulation_waterEqualisation},
 		{"ambientAirTemp", simulation_ambientAirTemp},
@@ -958,6 +962,7 @@ void LuaScriptInterface::set_map(int x, int y, int width, int height, float valu
 			else if (map == 5)
 				luacon_sim->gravmap[ny*XRES/CELL+nx] = value; //gravx/y don't seem to work, but this does. opposite of tpt
 		}
+	luacon_sim->WakeChunks(x*CELL, y*CELL, (x+width)*CELL-1, (y+height)*CELL-1);
 }
 
 int LuaScriptInterface::simulation_partNeighbours(lua_State * l)
@@ -1076,6 +1081,7 @@ int LuaScriptInterface::simulation_partPosition(lua_State * l)
 	{
 		luacon_sim->parts[particleID].x = lua_tonumber(l, 2);
 		luacon_sim->parts[particleID].y = lua_tonumber(l, 3);
+		luacon_sim->InvalidateStackIndex();
 		return 0;
 	}
 	else
@@ -1140,6 +1146,7 @@ int LuaScriptInterface::simulation_partProperty(lua_State * l)
 		else
 		{
 			LuaSetProperty(l, *prop, propertyAddress, 3);
+			luacon_sim->InvalidateStackIndex();
 		}
 		return 0;
 	}
@@ -1745,6 +1752,7 @@ int LuaScriptInterface::simulation_resetPressure(lua_State * l)
 		{
 			luacon_sim->air->pv[ny][nx] = 0;
 		}
+	luacon_sim->WakeChunks(x1*CELL, y1*CELL, (x1+width)*CELL-1, (y1+height)*CELL-1);
 	return 0;
 }
 
@@ -1943,6 +1951,62 @@ int LuaScriptInterface::simulation_airMode(lua_State * l)
 	return 0;
 }
 
+int LuaScriptInterface::simulation_airThreads(lua_State * l)
+{
+	int acount = lua_gettop(l);
+	if (acount == 0)
+	{
+		lua_pushinteger(l, luacon_sim->air->GetThreads());
+		return 1;
+	}
+	int threads = luaL_checkint(l, 1);
+	if (threads < 1 || threads > 64)
+		return luaL_error(l, "Invalid thread count %d", threads);
+	luacon_sim->air->SetThreads(threads);
+	return 0;
+}
+
+int LuaScriptInterface::simulation_parallelHeat(lua_State * l)
+{
+	int acount = lua_gettop(l);
+	if (acount == 0)
+	{
+		lua_pushinteger(l, luacon_sim->parallel_heat ? luacon_sim->heatThreadPool.GetThreads() : 0);
+		return 1;
+	}
+	int threads = luaL_checkint(l, 1);
+	if (threads < 0 || threads > 64)
+		return luaL_error(l, "Invalid thread count %d", threads);
+	luacon_sim->SetParallelHeat(threads);
+	return 0;
+}
+
+int LuaScriptInterface::simulation_chunkSleep(lua_State * l)
+{
+	int acount = lua_gettop(l);
+	if (acount == 0)
+	{
+		lua_pushboolean(l, luacon_sim->chunk_sleep);
+		return 1;
+	}
+	luacon_sim->SetChunkSleep(lua_toboolean(l, 1));
+	return 0;
+}
+
+int LuaScriptInterface::simulation_ticksPerFrame(lua_State * l)
+{
+	if (lua_gettop(l) == 0)
+	{
+		lua_pushinteger(l, luacon_model->GetTicksPerFrame());
+		return 1;
+	}
+	int ticksPerFrame = luaL_checkint(l, 1);
+	if (ticksPerFrame < 0)
+		return luaL_error(l, "Ticks per frame must be 0 (as many as fit in a frame) or more");
+	luacon_model->SetTicksPerFrame(ticksPerFrame);
+	return 0;
+}
+
 int LuaScriptInterface::simulation_waterEqualisation(lua_State * l)
 {
 	int acount = lua_gettop(l);
@@ -2272,6 +2336,8 @@ void LuaScriptInterface::initRendererAPI()
 		{"zoomEnabled", renderer_zoomEnabled},
 		{"zoomWindow", renderer_zoomWindowInfo},
 		{"zoomScope", renderer_zoomScopeInfo},
+		{"pipelined", renderer_pipelined},
+		{"tileThreads", renderer_tileThreads},
 		{NULL, NULL}
 	};
 	luaL_register(l, "renderer", rendererAPIMethods);
@@ -2466,6 +2532,31 @@ int LuaScriptInterface::renderer_showBrush(lua_State * l)
 	return 0;
 }
 
+int LuaScriptInterface::renderer_pipelined(lua_State * l)
+{
+	if (lua_gettop(l) == 0)
+	{
+		lua_pushboolean(l, luacon_ren->GetPipelined());
+		return 1;
+	}
+	luacon_ren->SetPipelined(lua_toboolean(l, 1));
+	return 0;
+}
+
+int LuaScriptInterface::renderer_tileThreads(lua_State * l)
+{
+	if (lua_gettop(l) == 0)
+	{
+		lua_pushinteger(l, luacon_ren->GetTileThreads());
+		return 1;
+	}
+	int threads = luaL_checkint(l, 1);
+	if (threads < 0 || threads > 64)
+		return luaL_error(l, "Invalid thread count %d", threads);
+	luacon_ren->SetTileThreads(threads);
+	return 0;
+}
+
 int LuaScriptInterface::renderer_depth3d(lua_State * l)
 {
 	return luaL_error(l, "This feature is no longer supported");
@@ -2769,6 +2860,7 @@ int LuaScriptInterface::elements_loadDefault(lua_State * l)
 	}
 	luacon_ci->custom_init_can_move();
 	std::fill(luacon_ren->graphicscache, luacon_ren->graphicscache+PT_NUM, gcache_item());
+	luacon_clearGraphicsMemo();
 	return 0;
 }
 
@@ -2974,10 +3066,14 @@ int LuaScriptInterface::elements_element(lua_State * l)
 		if (lua_type(l, -1) == LUA_TFUNCTION)
 		{
 			lua_gr_func[id].Assign(l, -1);
+			luacon_graphicsFuncsChanged();
+			luacon_setGraphicsPure(id, false);
 		}
 		else if (lua_type(l, -1) == LUA_TBOOLEAN && !lua_toboolean(l, -1))
 		{
 			lua_gr_func[id].Clear();
+			luacon_graphicsFuncsChanged();
+			luacon_setGraphicsPure(id, false);
 			luacon_sim->elements[id].Graphics = nullptr;
 		}
 		lua_pop(l, 1);
@@ -3153,10 +3249,14 @@ int LuaScriptInterface::elements_property(lua_State * l)
 			if (lua_type(l, 3) == LUA_TFUNCTION)
 			{
 				lua_gr_func[id].Assign(l, 3);
+				luacon_graphicsFuncsChanged();
+				luacon_setGraphicsPure(id, lua_toboolean(l, 4));
 			}
 			else if (lua_type(l, 3) == LUA_TBOOLEAN && !lua_toboolean(l, 3))
 			{
 				lua_gr_func[id].Clear();
+				luacon_graphicsFuncsChanged();
+				luacon_setGraphicsPure(id, false);
 				luacon_sim->elements[id].Graphics = NULL;
 			}
 			luacon_ren->graphicscache[id].isready = 0;
@@ -4288,7 +4388,11 @@ LuaScriptInterface::~LuaScriptInterface() {
 	lua_el_mode_v.clear();
 	lua_el_func_v.clear();
 	lua_gr_func_v.clear();
+	lua_gr_func = nullptr;
+	luacon_graphicsFuncsChanged();
 	lua_cd_func_v.clear();
+	for (int t = 0; t < PT_NUM; t++)
+		luacon_setGraphicsPure(t, false);
 	lua_close(l);
 	delete legacy;
 }
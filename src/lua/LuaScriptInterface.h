@@ -100,6 +100,10 @@ class LuaScriptInterface: public CommandInterface
 	static int simulation_edgeMode(lua_State * l);
 	static int simulation_gravityMode(lua_State * l);
 	static int simulation_airMode(lua_State * l);
+	static int simulation_airThreads(lua_State * l);
+	static int simulation_parallelHeat(lua_State * l);
+	static int simulation_chunkSleep(lua_State * l);
+	static int simulation_ticksPerFrame(lua_State * l);
 	static int simulation_waterEqualisation(lua_State * l);
 	static int simulation_ambientAirTemp(lua_State * l);
 	static int simulation_elementCount(lua_State * l);
@@ -127,6 +131,8 @@ class LuaScriptInterface: public CommandInterface
 	static int renderer_zoomEnabled(lua_State *l);
 	static int renderer_zoomWindowInfo(lua_State *l);
 	static int renderer_zoomScopeInfo(lua_State *l);
+	static int renderer_pipelined(lua_State * l);
+	static int renderer_tileThreads(lua_State * l);
 
 	//Elements
 	void initElementsAPI();
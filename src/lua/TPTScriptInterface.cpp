@@ -267,6 +267,7 @@ AnyType TPTScriptInterface::tptS_set(std::deque<String> * words)
 	int propertyOffset = GetPropertyOffset(property.Value().ToUtf8(), propertyFormat);
 	if (propertyOffset == -1)
 		throw GeneralException("Invalid property");
+	sim->InvalidateStackIndex();
 
 	//Selector
 	int newValue = 0;
@@ -555,6 +556,7 @@ AnyType TPTScriptInterface::tptS_reset(std::deque<String> * words)
 			{
 				sim->air->pv[ny][nx] = 0;
 			}
+		sim->WakeAllChunks();
 	}
 	else if (resetStr == "velocity")
 	{
@@ -564,6 +566,7 @@ AnyType TPTScriptInterface::tptS_reset(std::deque<String> * words)
 				sim->air->vx[ny][nx] = 0;
 				sim->air->vy[ny][nx] = 0;
 			}
+		sim->WakeAllChunks();
 	}
 	else if (resetStr == "sparks")
 	{
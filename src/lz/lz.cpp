@@ -0,0 +1,171 @@
+#include "lz.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// matches are found through a hash table of the last position each 4 byte
+// sequence was seen at
+#define LZ_HASH_BITS 16
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 0xFFFF
+// the format requires the last 5 bytes to be literals and the last match to
+// start at least 12 bytes before the end
+#define LZ_LAST_LITERALS 5
+#define LZ_MATCH_LIMIT 12
+// after this many misses in a row, the search starts skipping ahead faster
+// through data that doesn't compress
+#define LZ_SKIP_TRIGGER 6
+
+static uint32_t read32(const unsigned char *data)
+{
+	uint32_t value;
+	memcpy(&value, data, 4);
+	return value;
+}
+
+static uint32_t hash32(uint32_t sequence)
+{
+	return (sequence * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+static unsigned char *writeLength(unsigned char *out, size_t length)
+{
+	for (; length >= 255; length -= 255)
+		*out++ = 255;
+	*out++ = (unsigned char)length;
+	return out;
+}
+
+static unsigned char *writeSequence(unsigned char *out, const unsigned char *literals, size_t literalLength, size_t offset, size_t matchLength)
+{
+	unsigned char *token = out++;
+	*token = (unsigned char)((literalLength >= 15 ? 15 : literalLength) << 4);
+	if (literalLength >= 15)
+		out = writeLength(out, literalLength - 15);
+	memcpy(out, literals, literalLength);
+	out += literalLength;
+	if (!matchLength)
+		return out;
+	*out++ = (unsigned char)offset;
+	*out++ = (unsigned char)(offset >> 8);
+	matchLength -= LZ_MIN_MATCH;
+	*token |= (unsigned char)(matchLength >= 15 ? 15 : matchLength);
+	if (matchLength >= 15)
+		out = writeLength(out, matchLength - 15);
+	return out;
+}
+
+size_t LZCompressBound(size_t srcSize)
+{
+	return srcSize + srcSize / 255 + 16;
+}
+
+size_t LZCompress(char *dest, const char *srcData, size_t srcSize)
+{
+	const unsigned char *src = reinterpret_cast<const unsigned char *>(srcData);
+	unsigned char *out = reinterpret_cast<unsigned char *>(dest);
+	const unsigned char *anchor = src;
+	if (srcSize > LZ_MATCH_LIMIT)
+	{
+		std::vector<uint32_t> table(size_t(1) << LZ_HASH_BITS, 0);
+		const unsigned char *matchEnd = src + srcSize - LZ_LAST_LITERALS;
+		const unsigned char *searchEnd = src + srcSize - LZ_MATCH_LIMIT;
+		const unsigned char *in = src + 1;
+		size_t misses = 0;
+		while (in <= searchEnd)
+		{
+			uint32_t sequence = read32(in);
+			uint32_t &entry = table[hash32(sequence)];
+			const unsigned char *candidate = src + entry;
+			entry = uint32_t(in - src);
+			if (in - candidate > LZ_MAX_OFFSET || read32(candidate) != sequence)
+			{
+				in += 1 + (misses++ >> LZ_SKIP_TRIGGER);
+				continue;
+			}
+			misses = 0;
+			// extend the match backwards over literals that also match
+			while (in > anchor && candidate > src && in[-1] == candidate[-1])
+			{
+				in--;
+				candidate--;
+			}
+			const unsigned char *end = in + LZ_MIN_MATCH;
+			const unsigned char *candidateEnd = candidate + LZ_MIN_MATCH;
+			while (end < matchEnd && *end == *candidateEnd)
+			{
+				end++;
+				candidateEnd++;
+			}
+			out = writeSequence(out, anchor, in - anchor, in - candidate, end - in);
+			// positions inside the match are only added sparsely, which is
+			// enough to keep finding long repeats
+			table[hash32(read32(end - 2))] = uint32_t(end - 2 - src);
+			anchor = in = end;
+		}
+	}
+	out = writeSequence(out, anchor, src + srcSize - anchor, 0, 0);
+	return out - reinterpret_cast<unsigned char *>(dest);
+}
+
+bool LZDecompress(char *dest, size_t destSize, const char *srcData, size_t srcSize)
+{
+	const unsigned char *in = reinterpret_cast<const unsigned char *>(srcData);
+	const unsigned char *inEnd = in + srcSize;
+	unsigned char *out = reinterpret_cast<unsigned char *>(dest);
+	unsigned char *outStart = out;
+	unsigned char *outEnd = out + destSize;
+	auto readLength = [&in, inEnd](size_t &length) {
+		unsigned char byte;
+		do
+		{
+			if (in >= inEnd)
+				return false;
+			byte = *in++;
+			length += byte;
+		}
+		while (byte == 255);
+		return true;
+	};
+
+	while (in < inEnd)
+	{
+		unsigned char token = *in++;
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !readLength(literalLength))
+			return false;
+		if (literalLength > size_t(inEnd - in) || literalLength > size_t(outEnd - out))
+			return false;
+		memcpy(out, in, literalLength);
+		in += literalLength;
+		out += literalLength;
+		// the last sequence has no match
+		if (in == inEnd)
+			break;
+
+		if (inEnd - in < 2)
+			return false;
+		size_t offset = in[0] | (in[1] << 8);
+		in += 2;
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !readLength(matchLength))
+			return false;
+		matchLength += LZ_MIN_MATCH;
+		if (!offset || offset > size_t(out - outStart) || matchLength > size_t(outEnd - out))
+			return false;
+		const unsigned char *match = out - offset;
+		if (offset >= matchLength)
+		{
+			memcpy(out, match, matchLength);
+			out += matchLength;
+		}
+		else
+		{
+			// the match overlaps the bytes it produces
+			for (size_t i = 0; i < matchLength; i++)
+				*out++ = match[i];
+		}
+	}
+	return out == outEnd;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+
+// A small LZ77 codec that trades compression ratio for speed, for data that
+// is written and read back often and never leaves this machine. The output
+// is in the LZ4 block format: a series of sequences, each a token, a run of
+// literal bytes, and a match against earlier output. It carries no header,
+// so the decompressed size has to be stored alongside it.
+
+// the largest possible compressed size of srcSize bytes
+size_t LZCompressBound(size_t srcSize);
+
+// dest must have room for LZCompressBound(srcSize) bytes; returns the
+// compressed size
+size_t LZCompress(char *dest, const char *srcData, size_t srcSize);
+
+// returns false unless srcData decompresses to exactly destSize bytes
+bool LZDecompress(char *dest, size_t destSize, const char *srcData, size_t srcSize);
@@ -1,8 +1,15 @@
 #include "Air.h"
 
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 
+#if defined(__AVX2__)
+# include <immintrin.h>
+#elif defined(X86_SSE2)
+# include <emmintrin.h>
+#endif
+
 #include "Simulation.h"
 #include "ElementClasses.h"
 #include "common/tpt-rand.h"
@@ -23,6 +30,176 @@ float fvx[YRES/CELL][XRES/CELL], fvy[YRES/CELL][XRES/CELL];
 
 float hv[YRES/CELL][XRES/CELL], ohv[YRES/CELL][XRES/CELL]; // For Ambient Heat */
 
+// Row kernels for the parts of update_air that are plain arithmetic on whole
+// rows. The vector versions do exactly the same operations in the same order
+// as the scalar ones, just several cells at a time, so the results match.
+// AVX2 is only used when the compiler already targets it (native builds),
+// otherwise the x86_sse option decides whether SSE2 is available. When
+// vectorised is false, the kernels run only their scalar loops, so the
+// runner can check that both give the same results.
+#if defined(__AVX2__)
+# define AIR_SIMD_WIDTH 8
+typedef __m256 air_vec;
+static inline air_vec air_load(const float *p) { return _mm256_loadu_ps(p); }
+static inline void air_store(float *p, air_vec v) { _mm256_storeu_ps(p, v); }
+static inline air_vec air_set1(float f) { return _mm256_set1_ps(f); }
+static inline air_vec air_add(air_vec a, air_vec b) { return _mm256_add_ps(a, b); }
+static inline air_vec air_sub(air_vec a, air_vec b) { return _mm256_sub_ps(a, b); }
+static inline air_vec air_mul(air_vec a, air_vec b) { return _mm256_mul_ps(a, b); }
+static inline air_vec air_and(air_vec a, air_vec b) { return _mm256_and_ps(a, b); }
+static inline air_vec air_select(air_vec mask, air_vec a, air_vec b) { return _mm256_blendv_ps(b, a, mask); }
+// all bits set in the lanes where the byte is zero
+static inline air_vec air_zero_mask(const unsigned char *p)
+{
+	__m256i b = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)p));
+	return _mm256_castsi256_ps(_mm256_cmpeq_epi32(b, _mm256_setzero_si256()));
+}
+#elif defined(X86_SSE2)
+# define AIR_SIMD_WIDTH 4
+typedef __m128 air_vec;
+static inline air_vec air_load(const float *p) { return _mm_loadu_ps(p); }
+static inline void air_store(float *p, air_vec v) { _mm_storeu_ps(p, v); }
+static inline air_vec air_set1(float f) { return _mm_set1_ps(f); }
+static inline air_vec air_add(air_vec a, air_vec b) { return _mm_add_ps(a, b); }
+static inline air_vec air_sub(air_vec a, air_vec b) { return _mm_sub_ps(a, b); }
+static inline air_vec air_mul(air_vec a, air_vec b) { return _mm_mul_ps(a, b); }
+static inline air_vec air_and(air_vec a, air_vec b) { return _mm_and_ps(a, b); }
+static inline air_vec air_select(air_vec mask, air_vec a, air_vec b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+static inline air_vec air_zero_mask(const unsigned char *p)
+{
+	int bytes;
+	memcpy(&bytes, p, sizeof(bytes));
+	__m128i zero = _mm_setzero_si128();
+	__m128i b = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+	return _mm_castsi128_ps(_mm_cmpeq_epi32(b, zero));
+}
+#else
+# define AIR_SIMD_WIDTH 0
+#endif
+
+// pressure adjustments from velocity, for cells [xStart, xEnd) of a row that has a row above it
+static void pressure_from_velocity(float *pv, const float *vx, const float *vy, const float *vyAbove, int xStart, int xEnd, bool vectorised)
+{
+	int x = xStart;
+#if AIR_SIMD_WIDTH
+	air_vec zero = air_set1(0.0f), ploss = air_set1(AIR_PLOSS), tstep = air_set1(AIR_TSTEPP);
+	for (; vectorised && x+AIR_SIMD_WIDTH<=xEnd; x+=AIR_SIMD_WIDTH)
+	{
+		air_vec dp = air_add(zero, air_sub(air_load(vx+x-1), air_load(vx+x)));
+		dp = air_add(dp, air_sub(air_load(vyAbove+x), air_load(vy+x)));
+		air_store(pv+x, air_add(air_mul(air_load(pv+x), ploss), air_mul(dp, tstep)));
+	}
+#endif
+	for (; x<xEnd; x++)
+	{
+		float dp = 0.0f;
+		dp += vx[x-1] - vx[x];
+		dp += vyAbove[x] - vy[x];
+		pv[x] *= AIR_PLOSS;
+		pv[x] += dp*AIR_TSTEPP;
+	}
+}
+
+// velocity adjustments from pressure, for cells [0, count) of a row that has a row below it
+static void velocity_from_pressure(float *vx, float *vy, const float *pv, const float *pvBelow, const unsigned char *blockair, const unsigned char *blockairBelow, int count, bool vectorised)
+{
+	int x = 0;
+#if AIR_SIMD_WIDTH
+	air_vec zero = air_set1(0.0f), vloss = air_set1(AIR_VLOSS), tstep = air_set1(AIR_TSTEPV);
+	// blockair[x+1] is read for the last lane, so stop a cell early
+	for (; vectorised && x+AIR_SIMD_WIDTH<count; x+=AIR_SIMD_WIDTH)
+	{
+		air_vec p = air_load(pv+x);
+		air_vec dx = air_add(zero, air_sub(p, air_load(pv+x+1)));
+		air_vec dy = air_add(zero, air_sub(p, air_load(pvBelow+x)));
+		air_vec nvx = air_add(air_mul(air_load(vx+x), vloss), air_mul(dx, tstep));
+		air_vec nvy = air_add(air_mul(air_load(vy+x), vloss), air_mul(dy, tstep));
+		air_vec open = air_zero_mask(blockair+x);
+		air_store(vx+x, air_and(nvx, air_and(open, air_zero_mask(blockair+x+1))));
+		air_store(vy+x, air_and(nvy, air_and(open, air_zero_mask(blockairBelow+x))));
+	}
+#endif
+	for (; x<count; x++)
+	{
+		float dx = 0.0f, dy = 0.0f;
+		dx += pv[x] - pv[x+1];
+		dy += pv[x] - pvBelow[x];
+		vx[x] *= AIR_VLOSS;
+		vy[x] *= AIR_VLOSS;
+		vx[x] += dx*AIR_TSTEPV;
+		vy[x] += dy*AIR_TSTEPV;
+		if (blockair[x] || blockair[x+1])
+			vx[x] = 0;
+		if (blockair[x] || blockairBelow[x])
+			vy[x] = 0;
+	}
+}
+
+// 3x3 blur of vx, vy and pv around each cell of row y, neighbours that are
+// walls or too close to the edge contribute the centre cell's value instead
+static void blur_row(const Air &air, int y, float *dx, float *dy, float *dp, bool vectorised)
+{
+	auto blur_cell = [&air, y, dx, dy, dp](int x) {
+		float f;
+		dx[x] = 0.0f;
+		dy[x] = 0.0f;
+		dp[x] = 0.0f;
+		for (int j=-1; j<2; j++)
+			for (int i=-1; i<2; i++)
+				if (y+j>0 && y+j<YRES/CELL-1 &&
+				        x+i>0 && x+i<XRES/CELL-1 &&
+				        !air.bmap_blockair[y+j][x+i])
+				{
+					f = air.kernel[i+1+(j+1)*3];
+					dx[x] += air.vx[y+j][x+i]*f;
+					dy[x] += air.vy[y+j][x+i]*f;
+					dp[x] += air.pv[y+j][x+i]*f;
+				}
+				else
+				{
+					f = air.kernel[i+1+(j+1)*3];
+					dx[x] += air.vx[y][x]*f;
+					dy[x] += air.vy[y][x]*f;
+					dp[x] += air.pv[y][x]*f;
+				}
+	};
+	int x = 0;
+#if AIR_SIMD_WIDTH
+	// every neighbour column of these cells is away from the edge, only walls need checking
+	for (; x<2; x++)
+		blur_cell(x);
+	for (; vectorised && x+AIR_SIMD_WIDTH<=XRES/CELL-2; x+=AIR_SIMD_WIDTH)
+	{
+		air_vec cvx = air_load(&air.vx[y][x]), cvy = air_load(&air.vy[y][x]), cpv = air_load(&air.pv[y][x]);
+		air_vec sx = air_set1(0.0f), sy = sx, sp = sx;
+		for (int j=-1; j<2; j++)
+		{
+			bool rowOpen = y+j>0 && y+j<YRES/CELL-1;
+			for (int i=-1; i<2; i++)
+			{
+				air_vec f = air_set1(air.kernel[i+1+(j+1)*3]);
+				air_vec nvx = cvx, nvy = cvy, npv = cpv;
+				if (rowOpen)
+				{
+					air_vec open = air_zero_mask(&air.bmap_blockair[y+j][x+i]);
+					nvx = air_select(open, air_load(&air.vx[y+j][x+i]), cvx);
+					nvy = air_select(open, air_load(&air.vy[y+j][x+i]), cvy);
+					npv = air_select(open, air_load(&air.pv[y+j][x+i]), cpv);
+				}
+				sx = air_add(sx, air_mul(nvx, f));
+				sy = air_add(sy, air_mul(nvy, f));
+				sp = air_add(sp, air_mul(npv, f));
+			}
+		}
+		air_store(dx+x, sx);
+		air_store(dy+x, sy);
+		air_store(dp+x, sp);
+	}
+#endif
+	for (; x<XRES/CELL; x++)
+		blur_cell(x);
+}
+
 void Air::make_kernel(void) //used for velocity
 {
 	int i, j;
@@ -44,17 +221,18 @@ void Air::Clear()
 	std::fill(&pv[0][0], &pv[0][0]+((XRES/CELL)*(YRES/CELL)), 0.0f);
 	std::fill(&vy[0][0], &vy[0][0]+((XRES/CELL)*(YRES/CELL)), 0.0f);
 	std::fill(&vx[0][0], &vx[0][0]+((XRES/CELL)*(YRES/CELL)), 0.0f);
+	sim.WakeAllChunks();
 }
 
 void Air::ClearAirH()
 {
 	std::fill(&hv[0][0], &hv[0][0]+((XRES/CELL)*(YRES/CELL)), ambientAirTemp);
+	sim.WakeAllChunks();
 }
 
 void Air::update_airh(void)
 {
-	int x, y, i, j;
-	float odh, dh, dx, dy, f, tx, ty;
+	int i;
 	for (i=0; i<YRES/CELL; i++) //reduces pressure/velocity on the edges every frame
 	{
 		hv[i][0] = ambientAirTemp;
@@ -71,70 +249,86 @@ void Air::update_airh(void)
 		hv[YRES/CELL-2][i] = ambientAirTemp;
 		hv[YRES/CELL-1][i] = ambientAirTemp;
 	}
-	for (y=0; y<YRES/CELL; y++) //update velocity and pressure
+	// Hot air rising changes vy as the grid is walked, and cells further along
+	// pick up the already changed vy of the cells before them. Work out the new
+	// vy for every cell first so that bands of rows can be updated independently
+	// and still see exactly what the old single pass saw.
+	bool verticalGravity = !sim.gravityMode;
+	if (verticalGravity)
 	{
-		for (x=0; x<XRES/CELL; x++)
+		threadPool.ParallelFor(YRES/CELL, [this](int yStart, int yEnd) {
+			for (int y=yStart; y<yEnd; y++)
+				for (int x=0; x<XRES/CELL; x++)
+				{ //Vertical gravity only for the time being
+					float airdiff = hv[y-1][x]-hv[y][x];
+					ovy[y][x] = vy[y][x];
+					if(airdiff>0 && !(bmap_blockairh[y-1][x]&0x8))
+						ovy[y][x] -= airdiff/5000.0f;
+				}
+		});
+	}
+	// neighbours above and to the left have already been visited in raster order
+	float (*vyBefore)[XRES/CELL] = verticalGravity ? ovy : vy;
+
+	threadPool.ParallelFor(YRES/CELL, [this, vyBefore](int yStart, int yEnd) {
+		int x, y, i, j;
+		float odh, dh, dx, dy, f, tx, ty;
+		for (y=yStart; y<yEnd; y++) //update velocity and pressure
 		{
-			dh = 0.0f;
-			dx = 0.0f;
-			dy = 0.0f;
-			for (j=-1; j<2; j++)
+			for (x=0; x<XRES/CELL; x++)
 			{
-				for (i=-1; i<2; i++)
+				dh = 0.0f;
+				dx = 0.0f;
+				dy = 0.0f;
+				for (j=-1; j<2; j++)
 				{
-					if (y+j>0 && y+j<YRES/CELL-2 &&
-					        x+i>0 && x+i<XRES/CELL-2 &&
-					        !(bmap_blockairh[y+j][x+i]&0x8))
-						{
-						f = kernel[i+1+(j+1)*3];
-						dh += hv[y+j][x+i]*f;
-						dx += vx[y+j][x+i]*f;
-						dy += vy[y+j][x+i]*f;
-					}
-					else
+					for (i=-1; i<2; i++)
 					{
-						f = kernel[i+1+(j+1)*3];
-						dh += hv[y][x]*f;
-						dx += vx[y][x]*f;
-						dy += vy[y][x]*f;
+						if (y+j>0 && y+j<YRES/CELL-2 &&
+						        x+i>0 && x+i<XRES/CELL-2 &&
+						        !(bmap_blockairh[y+j][x+i]&0x8))
+							{
+							f = kernel[i+1+(j+1)*3];
+							dh += hv[y+j][x+i]*f;
+							dx += vx[y+j][x+i]*f;
+							dy += ((j < 0 || (j == 0 && i < 0)) ? vyBefore : vy)[y+j][x+i]*f;
+						}
+						else
+						{
+							f = kernel[i+1+(j+1)*3];
+							dh += hv[y][x]*f;
+							dx += vx[y][x]*f;
+							dy += vy[y][x]*f;
+						}
 					}
 				}
+				tx = x - dx*0.7f;
+				ty = y - dy*0.7f;
+				i = (int)tx;
+				j = (int)ty;
+				tx -= i;
+				ty -= j;
+				if (i>=2 && i<XRES/CELL-3 && j>=2 && j<YRES/CELL-3)
+				{
+					odh = dh;
+					dh *= 1.0f - AIR_VADV;
+					dh += AIR_VADV*(1.0f-tx)*(1.0f-ty)*((bmap_blockairh[j][i]&0x8) ? odh : hv[j][i]);
+					dh += AIR_VADV*tx*(1.0f-ty)*((bmap_blockairh[j][i+1]&0x8) ? odh : hv[j][i+1]);
+					dh += AIR_VADV*(1.0f-tx)*ty*((bmap_blockairh[j+1][i]&0x8) ? odh : hv[j+1][i]);
+					dh += AIR_VADV*tx*ty*((bmap_blockairh[j+1][i+1]&0x8) ? odh : hv[j+1][i+1]);
+				}
+				ohv[y][x] = dh;
 			}
-			tx = x - dx*0.7f;
-			ty = y - dy*0.7f;
-			i = (int)tx;
-			j = (int)ty;
-			tx -= i;
-			ty -= j;
-			if (i>=2 && i<XRES/CELL-3 && j>=2 && j<YRES/CELL-3)
-			{
-				odh = dh;
-				dh *= 1.0f - AIR_VADV;
-				dh += AIR_VADV*(1.0f-tx)*(1.0f-ty)*((bmap_blockairh[j][i]&0x8) ? odh : hv[j][i]);
-				dh += AIR_VADV*tx*(1.0f-ty)*((bmap_blockairh[j][i+1]&0x8) ? odh : hv[j][i+1]);
-				dh += AIR_VADV*(1.0f-tx)*ty*((bmap_blockairh[j+1][i]&0x8) ? odh : hv[j+1][i]);
-				dh += AIR_VADV*tx*ty*((bmap_blockairh[j+1][i+1]&0x8) ? odh : hv[j+1][i+1]);
-			}
-			if(!sim.gravityMode)
-			{ //Vertical gravity only for the time being
-				float airdiff = hv[y-1][x]-hv[y][x];
-				if(airdiff>0 && !(bmap_blockairh[y-1][x]&0x8))
-					vy[y][x] -= airdiff/5000.0f;
-			}
-			ohv[y][x] = dh;
 		}
-	}
+	});
 	memcpy(hv, ohv, sizeof(hv));
+	if (verticalGravity)
+		memcpy(vy, ovy, sizeof(vy));
 }
 
 void Air::update_air(void)
 {
-	int x = 0, y = 0, i = 0, j = 0;
-	float dp = 0.0f, dx = 0.0f, dy = 0.0f, f = 0.0f, tx = 0.0f, ty = 0.0f;
-	const float advDistanceMult = 0.7f;
-	float stepX, stepY;
-	int stepLimit, step;
-
+	int i;
 	if (airMode != 4) { //airMode 4 is no air/pressure update
 
 		for (i=0; i<YRES/CELL; i++) //reduces pressure/velocity on the edges every frame
@@ -170,170 +364,149 @@ void Air::update_air(void)
 			vy[YRES/CELL-1][i] = vy[YRES/CELL-1][i]*0.9f;
 		}
 
-		for (j=1; j<YRES/CELL; j++) //clear some velocities near walls
-		{
-			for (i=1; i<XRES/CELL; i++)
+		// Each pass only reads what the previous ones wrote, so rows can be split
+		// into bands between passes without changing the result. Clearing
+		// velocities near walls is done per destination row for the same reason.
+		threadPool.ParallelFor(YRES/CELL, [this](int yStart, int yEnd) {
+			for (int y=yStart; y<yEnd; y++) //clear some velocities near walls
 			{
-				if (bmap_blockair[j][i])
+				for (int x=0; x<XRES/CELL; x++)
 				{
-					vx[j][i] = 0.0f;
-					vx[j][i-1] = 0.0f;
-					vy[j][i] = 0.0f;
-					vy[j-1][i] = 0.0f;
+					if (y>=1 && ((x>=1 && bmap_blockair[y][x]) || (x+1<XRES/CELL && bmap_blockair[y][x+1])))
+						vx[y][x] = 0.0f;
+					if (x>=1 && ((y>=1 && bmap_blockair[y][x]) || (y+1<YRES/CELL && bmap_blockair[y+1][x])))
+						vy[y][x] = 0.0f;
 				}
 			}
-		}
+		});
 
-		for (y=1; y<YRES/CELL; y++) //pressure adjustments from velocity
-			for (x=1; x<XRES/CELL; x++)
-			{
-				dp = 0.0f;
-				dp += vx[y][x-1] - vx[y][x];
-				dp += vy[y-1][x] - vy[y][x];
-				pv[y][x] *= AIR_PLOSS;
-				pv[y][x] += dp*AIR_TSTEPP;
-			}
+		threadPool.ParallelFor(YRES/CELL, [this](int yStart, int yEnd) {
+			for (int y=std::max(yStart, 1); y<yEnd; y++) //pressure adjustments from velocity
+				pressure_from_velocity(pv[y], vx[y], vy[y], vy[y-1], 1, XRES/CELL, vectorised);
+		});
 
-		for (y=0; y<YRES/CELL-1; y++) //velocity adjustments from pressure
-			for (x=0; x<XRES/CELL-1; x++)
-			{
-				dx = dy = 0.0f;
-				dx += pv[y][x] - pv[y][x+1];
-				dy += pv[y][x] - pv[y+1][x];
-				vx[y][x] *= AIR_VLOSS;
-				vy[y][x] *= AIR_VLOSS;
-				vx[y][x] += dx*AIR_TSTEPV;
-				vy[y][x] += dy*AIR_TSTEPV;
-				if (bmap_blockair[y][x] || bmap_blockair[y][x+1])
-					vx[y][x] = 0;
-				if (bmap_blockair[y][x] || bmap_blockair[y+1][x])
-					vy[y][x] = 0;
-			}
+		threadPool.ParallelFor(YRES/CELL-1, [this](int yStart, int yEnd) {
+			for (int y=yStart; y<yEnd; y++) //velocity adjustments from pressure
+				velocity_from_pressure(vx[y], vy[y], pv[y], pv[y+1], bmap_blockair[y], bmap_blockair[y+1], XRES/CELL-1, vectorised);
+		});
 
-		for (y=0; y<YRES/CELL; y++) //update velocity and pressure
-			for (x=0; x<XRES/CELL; x++)
+		threadPool.ParallelFor(YRES/CELL, [this](int yStart, int yEnd) {
+			int x, y, i, j;
+			float dp, dx, dy, tx, ty;
+			const float advDistanceMult = 0.7f;
+			float stepX, stepY;
+			int stepLimit, step;
+			float blurredVx[XRES/CELL], blurredVy[XRES/CELL], blurredPv[XRES/CELL];
+			for (y=yStart; y<yEnd; y++) //update velocity and pressure
 			{
-				dx = 0.0f;
-				dy = 0.0f;
-				dp = 0.0f;
-				for (j=-1; j<2; j++)
-					for (i=-1; i<2; i++)
-						if (y+j>0 && y+j<YRES/CELL-1 &&
-						        x+i>0 && x+i<XRES/CELL-1 &&
-						        !bmap_blockair[y+j][x+i])
+				blur_row(*this, y, blurredVx, blurredVy, blurredPv, vectorised);
+				for (x=0; x<XRES/CELL; x++)
+				{
+					dx = blurredVx[x];
+					dy = blurredVy[x];
+					dp = blurredPv[x];
+
+					tx = x - dx*advDistanceMult;
+					ty = y - dy*advDistanceMult;
+					if ((dx*advDistanceMult>1.0f || dy*advDistanceMult>1.0f) && (tx>=2 && tx<XRES/CELL-2 && ty>=2 && ty<YRES/CELL-2))
+					{
+						// Trying to take velocity from far away, check whether there is an intervening wall. Step from current position to desired source location, looking for walls, with either the x or y step size being 1 cell
+						if (std::abs(dx)>std::abs(dy))
 						{
-							f = kernel[i+1+(j+1)*3];
-							dx += vx[y+j][x+i]*f;
-							dy += vy[y+j][x+i]*f;
-							dp += pv[y+j][x+i]*f;
+							stepX = (dx<0.0f) ? 1.f : -1.f;
+							stepY = -dy/fabsf(dx);
+							stepLimit = (int)(fabsf(dx*advDistanceMult));
 						}
 						else
 						{
-							f = kernel[i+1+(j+1)*3];
-							dx += vx[y][x]*f;
-							dy += vy[y][x]*f;
-							dp += pv[y][x]*f;
+							stepY = (dy<0.0f) ? 1.f : -1.f;
+							stepX = -dx/fabsf(dy);
+							stepLimit = (int)(fabsf(dy*advDistanceMult));
 						}
-
-				tx = x - dx*advDistanceMult;
-				ty = y - dy*advDistanceMult;
-				if ((dx*advDistanceMult>1.0f || dy*advDistanceMult>1.0f) && (tx>=2 && tx<XRES/CELL-2 && ty>=2 && ty<YRES/CELL-2))
-				{
-					// Trying to take velocity from far away, check whether there is an intervening wall. Step from current position to desired source location, looking for walls, with either the x or y step size being 1 cell
-					if (std::abs(dx)>std::abs(dy))
-					{
-						stepX = (dx<0.0f) ? 1.f : -1.f;
-						stepY = -dy/fabsf(dx);
-						stepLimit = (int)(fabsf(dx*advDistanceMult));
-					}
-					else
-					{
-						stepY = (dy<0.0f) ? 1.f : -1.f;
-						stepX = -dx/fabsf(dy);
-						stepLimit = (int)(fabsf(dy*advDistanceMult));
-					}
-					tx = float(x);
-					ty = float(y);
-					for (step=0; step<stepLimit; ++step)
-					{
-						tx += stepX;
-						ty += stepY;
-						if (bmap_blockair[(int)(ty+0.5f)][(int)(tx+0.5f)])
+						tx = float(x);
+						ty = float(y);
+						for (step=0; step<stepLimit; ++step)
+						{
+							tx += stepX;
+							ty += stepY;
+							if (bmap_blockair[(int)(ty+0.5f)][(int)(tx+0.5f)])
+							{
+								tx -= stepX;
+								ty -= stepY;
+								break;
+							}
+						}
+						if (step==stepLimit)
 						{
-							tx -= stepX;
-							ty -= stepY;
-							break;
+							// No wall found
+							tx = x - dx*advDistanceMult;
+							ty = y - dy*advDistanceMult;
 						}
 					}
-					if (step==stepLimit)
+					i = (int)tx;
+					j = (int)ty;
+					tx -= i;
+					ty -= j;
+					if (!bmap_blockair[y][x] && i>=2 && i<=XRES/CELL-3 &&
+					        j>=2 && j<=YRES/CELL-3)
 					{
-						// No wall found
-						tx = x - dx*advDistanceMult;
-						ty = y - dy*advDistanceMult;
-					}
-				}
-				i = (int)tx;
-				j = (int)ty;
-				tx -= i;
-				ty -= j;
-				if (!bmap_blockair[y][x] && i>=2 && i<=XRES/CELL-3 &&
-				        j>=2 && j<=YRES/CELL-3)
-				{
-					dx *= 1.0f - AIR_VADV;
-					dy *= 1.0f - AIR_VADV;
+						dx *= 1.0f - AIR_VADV;
+						dy *= 1.0f - AIR_VADV;
 
-					dx += AIR_VADV*(1.0f-tx)*(1.0f-ty)*vx[j][i];
-					dy += AIR_VADV*(1.0f-tx)*(1.0f-ty)*vy[j][i];
+						dx += AIR_VADV*(1.0f-tx)*(1.0f-ty)*vx[j][i];
+						dy += AIR_VADV*(1.0f-tx)*(1.0f-ty)*vy[j][i];
 
-					dx += AIR_VADV*tx*(1.0f-ty)*vx[j][i+1];
-					dy += AIR_VADV*tx*(1.0f-ty)*vy[j][i+1];
+						dx += AIR_VADV*tx*(1.0f-ty)*vx[j][i+1];
+						dy += AIR_VADV*tx*(1.0f-ty)*vy[j][i+1];
 
-					dx += AIR_VADV*(1.0f-tx)*ty*vx[j+1][i];
-					dy += AIR_VADV*(1.0f-tx)*ty*vy[j+1][i];
+						dx += AIR_VADV*(1.0f-tx)*ty*vx[j+1][i];
+						dy += AIR_VADV*(1.0f-tx)*ty*vy[j+1][i];
 
-					dx += AIR_VADV*tx*ty*vx[j+1][i+1];
-					dy += AIR_VADV*tx*ty*vy[j+1][i+1];
-				}
+						dx += AIR_VADV*tx*ty*vx[j+1][i+1];
+						dy += AIR_VADV*tx*ty*vy[j+1][i+1];
+					}
 
-				if (bmap[y][x] == WL_FAN)
-				{
-					dx += fvx[y][x];
-					dy += fvy[y][x];
-				}
-				// pressure/velocity caps
-				if (dp > 256.0f) dp = 256.0f;
-				if (dp < -256.0f) dp = -256.0f;
-				if (dx > 256.0f) dx = 256.0f;
-				if (dx < -256.0f) dx = -256.0f;
-				if (dy > 256.0f) dy = 256.0f;
-				if (dy < -256.0f) dy = -256.0f;
+					if (bmap[y][x] == WL_FAN)
+					{
+						dx += fvx[y][x];
+						dy += fvy[y][x];
+					}
+					// pressure/velocity caps
+					if (dp > 256.0f) dp = 256.0f;
+					if (dp < -256.0f) dp = -256.0f;
+					if (dx > 256.0f) dx = 256.0f;
+					if (dx < -256.0f) dx = -256.0f;
+					if (dy > 256.0f) dy = 256.0f;
+					if (dy < -256.0f) dy = -256.0f;
 
 
-				switch (airMode)
-				{
-				default:
-				case 0:  //Default
-					break;
-				case 1:  //0 Pressure
-					dp = 0.0f;
-					break;
-				case 2:  //0 Velocity
-					dx = 0.0f;
-					dy = 0.0f;
-					break;
-				case 3: //0 Air
-					dx = 0.0f;
-					dy = 0.0f;
-					dp = 0.0f;
-					break;
-				case 4: //No Update
-					break;
-				}
+					switch (airMode)
+					{
+					default:
+					case 0:  //Default
+						break;
+					case 1:  //0 Pressure
+						dp = 0.0f;
+						break;
+					case 2:  //0 Velocity
+						dx = 0.0f;
+						dy = 0.0f;
+						break;
+					case 3: //0 Air
+						dx = 0.0f;
+						dy = 0.0f;
+						dp = 0.0f;
+						break;
+					case 4: //No Update
+						break;
+					}
 
-				ovx[y][x] = dx;
-				ovy[y][x] = dy;
-				opv[y][x] = dp;
+					ovx[y][x] = dx;
+					ovy[y][x] = dy;
+					opv[y][x] = dp;
+				}
 			}
+		});
 		memcpy(vx, ovx, sizeof(vx));
 		memcpy(vy, ovy, sizeof(vy));
 		memcpy(pv, opv, sizeof(pv));
@@ -350,6 +523,7 @@ void Air::Invert()
 			vx[ny][nx] = -vx[ny][nx];
 			vy[ny][nx] = -vy[ny][nx];
 		}
+	sim.WakeAllChunks();
 }
 
 // called when loading saves / stamps to ensure nothing "leaks" the first frame
@@ -385,7 +559,8 @@ void Air::RecalculateBlockAirMaps()
 Air::Air(Simulation & simulation):
 	sim(simulation),
 	airMode(0),
-	ambientAirTemp(R_TEMP + 273.15f)
+	ambientAirTemp(R_TEMP + 273.15f),
+	vectorised(true)
 {
 	//Simulation should do this.
 	make_kernel();
@@ -2,6 +2,8 @@
 #define AIR_H
 #include "Config.h"
 
+#include "common/ThreadPool.h"
+
 class Simulation;
 
 class Air
@@ -27,6 +29,12 @@ public:
 	unsigned char bmap_blockair[YRES/CELL][XRES/CELL];
 	unsigned char bmap_blockairh[YRES/CELL][XRES/CELL];
 	float kernel[9];
+	// false runs the scalar row kernels even where vector ones are built in
+	bool vectorised;
+	// bands of rows are updated in parallel, results are identical for any thread count
+	ThreadPool threadPool;
+	void SetThreads(int threads) { threadPool.SetThreads(threads); }
+	int GetThreads() const { return threadPool.GetThreads(); }
 	void make_kernel(void);
 	void update_airh(void);
 	void update_air(void);
@@ -0,0 +1,89 @@
+#ifndef Simulation_FloodFill_h
+#define Simulation_FloodFill_h
+
+#include "CoordStack.h"
+
+// Scanline flood fill shared by the simulation's flood tools. A seed is
+// extended left and right as far as canFill allows, fillSpan is called once
+// for the whole span, and each run of fillable pixels in the rows dy above
+// and below the span is then queued as a single seed, instead of every pixel
+// in it. Only pixels within the (inclusive) bounds are visited.
+//
+// canFill(x, y) must be false for pixels fillSpan has already filled, or the
+// fill never ends; callers whose fill doesn't change what canFill looks at
+// should keep a bitmap of filled pixels. fillSpan(x1, x2, y) returns false
+// to stop the fill early. Throws CoordStackOverflowException if too many
+// seeds are queued.
+class FloodFill
+{
+	CoordStack &cs;
+	int minX, minY, maxX, maxY, dy;
+
+public:
+	FloodFill(CoordStack &cs, int minX, int minY, int maxX, int maxY, int dy = 1):
+		cs(cs),
+		minX(minX),
+		minY(minY),
+		maxX(maxX),
+		maxY(maxY),
+		dy(dy)
+	{
+		cs.clear();
+	}
+
+	void Push(int x, int y)
+	{
+		cs.push(x, y);
+	}
+
+	// queues a seed for each run of pixels between x1 and x2 on row y that
+	// canSeed accepts, if the row is within bounds
+	template<class CanSeed>
+	void SeedRuns(int x1, int x2, int y, CanSeed canSeed)
+	{
+		if (y < minY || y > maxY)
+			return;
+		bool inRun = false;
+		for (int x = x1; x <= x2; x++)
+		{
+			bool seed = canSeed(x, y);
+			if (seed && !inRun)
+				cs.push(x, y);
+			inRun = seed;
+		}
+	}
+
+	// seedSpan(x1, x2, y) queues the seeds for the rows next to a filled span,
+	// usually with SeedRuns; returns false if fillSpan stopped the fill
+	template<class CanFill, class FillSpan, class SeedSpan>
+	bool Run(int x, int y, CanFill canFill, FillSpan fillSpan, SeedSpan seedSpan)
+	{
+		cs.push(x, y);
+		while (cs.getSize())
+		{
+			cs.pop(x, y);
+			if (!canFill(x, y))
+				continue;
+			int x1 = x, x2 = x;
+			while (x1 > minX && canFill(x1 - 1, y))
+				x1--;
+			while (x2 < maxX && canFill(x2 + 1, y))
+				x2++;
+			if (!fillSpan(x1, x2, y))
+				return false;
+			seedSpan(x1, x2, y);
+		}
+		return true;
+	}
+
+	template<class CanFill, class FillSpan>
+	bool Run(int x, int y, CanFill canFill, FillSpan fillSpan)
+	{
+		return Run(x, y, canFill, fillSpan, [this, &canFill](int x1, int x2, int y) {
+			SeedRuns(x1, x2, y - dy, canFill);
+			SeedRuns(x1, x2, y + dy, canFill);
+		});
+	}
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "GOLBoard.h"
+
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static int countTrailingZeros(uint64_t word)
+{
+#ifdef _MSC_VER
+	unsigned long i;
+	if (_BitScanForward(&i, (unsigned long)word))
+		return i;
+	_BitScanForward(&i, (unsigned long)(word >> 32));
+	return i + 32;
+#else
+	return __builtin_ctzll(word);
+#endif
+}
+
+// bits of the last word of a row that are actual cells
+static const uint64_t lastWordMask = (GOLBoard::width % 64) ? (uint64_t(1) << (GOLBoard::width % 64)) - 1 : ~uint64_t(0);
+
+GOLBoard::GOLBoard():
+	live(height * rowWords),
+	west(3 * rowWords),
+	east(3 * rowWords)
+{
+}
+
+void GOLBoard::Clear()
+{
+	std::fill(live.begin(), live.end(), 0);
+}
+
+// bit x of rowWest is cell x-1 and bit x of rowEast is cell x+1, wrapping
+// around at the ends of the row
+void GOLBoard::ShiftRow(const uint64_t *row, uint64_t *rowWest, uint64_t *rowEast)
+{
+	for (int w = 0; w < rowWords; w++)
+	{
+		rowWest[w] = (row[w] << 1) | (w ? row[w - 1] >> 63 : 0);
+		rowEast[w] = (row[w] >> 1) | (w + 1 < rowWords ? row[w + 1] << 63 : 0);
+	}
+	rowWest[rowWords - 1] &= lastWordMask;
+	rowWest[0] |= (row[rowWords - 1] >> ((width - 1) % 64)) & 1;
+	rowEast[rowWords - 1] |= (row[0] & 1) << ((width - 1) % 64);
+}
+
+void GOLBoard::Evolve(unsigned int ruleset, std::vector<Change> &changes)
+{
+	// the row above, this row and the row below rotate through the three
+	// slots of west and east
+	auto rowAt = [this](int y) {
+		return &live[((y + height) % height) * rowWords];
+	};
+	auto slot = [](int y) {
+		return ((y % 3) + 3) % 3 * rowWords;
+	};
+	ShiftRow(rowAt(-1), &west[slot(-1)], &east[slot(-1)]);
+	ShiftRow(rowAt(0), &west[slot(0)], &east[slot(0)]);
+	for (int y = 0; y < height; y++)
+	{
+		ShiftRow(rowAt(y + 1), &west[slot(y + 1)], &east[slot(y + 1)]);
+		const uint64_t *above = rowAt(y - 1), *row = rowAt(y), *below = rowAt(y + 1);
+		const uint64_t *aboveWest = &west[slot(y - 1)], *aboveEast = &east[slot(y - 1)];
+		const uint64_t *rowWest = &west[slot(y)], *rowEast = &east[slot(y)];
+		const uint64_t *belowWest = &west[slot(y + 1)], *belowEast = &east[slot(y + 1)];
+		for (int w = 0; w < rowWords; w++)
+		{
+			// the three neighbours above and the three below each add up to
+			// two bits, the two beside to another two, then those are summed
+			// into a four bit count, bit n of count[n] for every cell
+			uint64_t a = aboveWest[w], b = above[w], c = aboveEast[w];
+			uint64_t top0 = a ^ b ^ c, top1 = (a & b) | (c & (a ^ b));
+			a = belowWest[w], b = below[w], c = belowEast[w];
+			uint64_t bottom0 = a ^ b ^ c, bottom1 = (a & b) | (c & (a ^ b));
+			uint64_t middle0 = rowWest[w] ^ rowEast[w], middle1 = rowWest[w] & rowEast[w];
+
+			uint64_t count[4];
+			count[0] = top0 ^ middle0 ^ bottom0;
+			uint64_t carry1 = (top0 & middle0) | (bottom0 & (top0 ^ middle0));
+			uint64_t twos = top1 ^ middle1 ^ bottom1;
+			uint64_t carry2 = (top1 & middle1) | (bottom1 & (top1 ^ middle1));
+			count[1] = twos ^ carry1;
+			uint64_t carry2b = twos & carry1;
+			count[2] = carry2 ^ carry2b;
+			count[3] = carry2 & carry2b;
+
+			// bits 0 to 8 of the ruleset are the neighbour counts a live cell
+			// survives with, bits 9 to 16 those an empty cell is born with
+			uint64_t survive = 0, born = 0;
+			for (int n = 0; n <= 8; n++)
+			{
+				bool survives = (ruleset >> n) & 1;
+				bool isBorn = n && ((ruleset >> (n + 8)) & 1);
+				if (!survives && !isBorn)
+					continue;
+				uint64_t match = ~uint64_t(0);
+				for (int bit = 0; bit < 4; bit++)
+					match &= ((n >> bit) & 1) ? count[bit] : ~count[bit];
+				if (survives)
+					survive |= match;
+				if (isBorn)
+					born |= match;
+			}
+			uint64_t cells = row[w];
+			uint64_t dies = cells & ~survive;
+			born &= ~cells;
+			if (w == rowWords - 1)
+				born &= lastWordMask;
+
+			uint64_t changed = dies | born;
+			while (changed)
+			{
+				int bit = countTrailingZeros(changed);
+				changed &= changed - 1;
+				Change change;
+				change.x = w * 64 + bit + CELL;
+				change.y = y + CELL;
+				change.born = (born >> bit) & 1;
+				changes.push_back(change);
+			}
+		}
+	}
+}
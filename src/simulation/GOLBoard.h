@@ -0,0 +1,53 @@
+#pragma once
+#include "Config.h"
+
+#include <cstdint>
+#include <vector>
+
+// Live Game of Life cells packed one bit per cell, so that neighbour counts
+// and rule lookups for 64 cells at a time are a handful of bitwise adds.
+// Covers the same area as SimulateGoL, CELL pixels in from each edge of the
+// simulation, and wraps around at its edges the same way.
+class GOLBoard
+{
+public:
+	static const int width = XRES - 2 * CELL;
+	static const int height = YRES - 2 * CELL;
+	static const int rowWords = (width + 63) / 64;
+
+	struct Change
+	{
+		int x, y;
+		bool born; // otherwise the live cell dies
+	};
+
+private:
+	std::vector<uint64_t> live;
+	// neighbours of the row being evolved, shifted one cell west and east
+	std::vector<uint64_t> west, east;
+
+	void ShiftRow(const uint64_t *row, uint64_t *rowWest, uint64_t *rowEast);
+
+public:
+	GOLBoard();
+
+	// x and y are simulation coordinates; returns false if the cell was already live
+	bool Set(int x, int y)
+	{
+		uint64_t &word = live[(y - CELL) * rowWords + (x - CELL) / 64];
+		uint64_t bit = uint64_t(1) << ((x - CELL) % 64);
+		bool wasLive = word & bit;
+		word |= bit;
+		return !wasLive;
+	}
+
+	bool Get(int x, int y) const
+	{
+		return (live[(y - CELL) * rowWords + (x - CELL) / 64] >> ((x - CELL) % 64)) & 1;
+	}
+
+	void Clear();
+	// appends the cells that change in the next generation under ruleset to
+	// changes, in the order SimulateGoL visits them (rows top to bottom)
+	void Evolve(unsigned int ruleset, std::vector<Change> &changes);
+};
@@ -145,7 +145,12 @@ void Gravity::gravity_update_async()
 
 	{
 		std::unique_lock<std::mutex> l(gravmutex, std::defer_lock);
-		if (l.try_lock())
+		if (synchronous)
+		{
+			l.lock();
+			gravcv.wait(l, [this]() { return grav_ready; });
+		}
+		if (l.owns_lock() || l.try_lock())
 		{
 			result = grav_ready;
 			if (result) //Did the gravity thread finish?
@@ -209,6 +214,8 @@ void Gravity::update_grav_async()
 			done = 1;
 			grav_ready = 1;
 			thread_done = gravthread_done;
+			// wake the main thread in case it's waiting for this result
+			gravcv.notify_one();
 		}
 		else
 		{
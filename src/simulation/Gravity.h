@@ -33,6 +33,8 @@ private:
 	int grav_ready = 0;
 	int gravthread_done = 0;
 	bool ignoreNextResult = false;
+	// wait for the gravity thread every frame instead of using whatever result is ready
+	bool synchronous = false;
 
 #ifdef GRAVFFT
 	bool grav_fft_status = false;
@@ -76,6 +78,7 @@ public:
 	unsigned char (*bmap)[XRES/CELL];
 
 	bool IsEnabled() { return enabled; }
+	void SetSynchronous(bool newSynchronous) { synchronous = newSynchronous; }
 
 	void Clear();
 
@@ -7,10 +7,12 @@
 
 struct Particle
 {
+	// the fields most updates and render_parts look at come first, so they
+	// are packed together and rarely span two cache lines
 	int type;
-	int life, ctype;
 	float x, y, vx, vy;
 	float temp;
+	int life, ctype;
 	float pavg[2];
 	int flags;
 	int tmp;
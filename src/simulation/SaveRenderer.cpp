@@ -7,12 +7,84 @@
 
 #include "Simulation.h"
 
-SaveRenderer::SaveRenderer(){
+#include "common/ThreadPool.h"
+
+#include <algorithm>
+
+SaveRenderer::SaveRenderer():
+	busyContexts(0)
+{
+#if defined(OGLR) || defined(OGLI)
+	// only one thread can use the GL context at a time
+	maxContexts = 1;
+#else
+	maxContexts = std::min(ThreadPool::HardwareThreads(), SAVERENDERER_MAX_CONTEXTS);
+#endif
+}
+
+SaveRenderer::Context * SaveRenderer::AcquireContext()
+{
+	std::unique_lock<std::mutex> lock(contextMutex);
+	// saves are rendered one at a time, as they used to be, while any element
+	// has a Lua graphics function, since they all share the one Lua state
+	contextAvailable.wait(lock, [this]() {
+		return busyContexts < (Renderer::LuaGraphicsInUse() ? 1 : maxContexts);
+	});
+	busyContexts++;
+	if (idleContexts.size())
+	{
+		Context * context = idleContexts.back();
+		idleContexts.pop_back();
+		return context;
+	}
+	lock.unlock();
+	try
+	{
+		return new Context();
+	}
+	catch (...)
+	{
+		lock.lock();
+		busyContexts--;
+		lock.unlock();
+		contextAvailable.notify_one();
+		throw;
+	}
+}
+
+void SaveRenderer::ReleaseContext(Context * context)
+{
+	{
+		std::lock_guard<std::mutex> lock(contextMutex);
+		idleContexts.push_back(context);
+		busyContexts--;
+	}
+	// with Lua graphics in use only one waiter may go ahead, but the others
+	// have to be woken to find that out when they are not
+	contextAvailable.notify_all();
+}
+
+SaveRenderer::ContextLease::ContextLease(SaveRenderer & saveRenderer):
+	saveRenderer(saveRenderer),
+	context(saveRenderer.AcquireContext())
+{
+	RNG::SetThreadInstance(&context->rng);
+}
+
+SaveRenderer::ContextLease::~ContextLease()
+{
+	RNG::SetThreadInstance(nullptr);
+	saveRenderer.ReleaseContext(context);
+}
+
+SaveRenderer::Context::Context()
+{
 	g = new Graphics();
 	sim = new Simulation();
 	ren = new Renderer(g, sim);
 	ren->decorations_enable = true;
 	ren->blackDecorations = true;
+	ren->SetRNG(&rng);
 
 #if defined(OGLR) || defined(OGLI)
 	glEnable(GL_TEXTURE_2D);
@@ -33,10 +105,25 @@ SaveRenderer::SaveRenderer(){
 #endif
 }
 
+SaveRenderer::Context::~Context()
+{
+#if defined(OGLR) || defined(OGLI)
+	glDeleteFramebuffers(1, &fbo);
+	glDeleteTextures(1, &fboTex);
+#endif
+	delete ren;
+	delete sim;
+	delete g;
+}
+
 VideoBuffer * SaveRenderer::Render(GameSave * save, bool decorations, bool fire, Renderer *renderModeSource)
 {
-	std::lock_guard<std::mutex> gx(renderMutex);
+	ContextLease lease(*this);
+	return lease.context->Render(save, decorations, fire, renderModeSource);
+}
 
+VideoBuffer * SaveRenderer::Context::Render(GameSave * save, bool decorations, bool fire, Renderer *renderModeSource)
+{
 	ren->ResetModes();
 	if (renderModeSource)
 	{
@@ -161,8 +248,6 @@ VideoBuffer * SaveRenderer::Render(GameSave * save, bool decorations, bool fire,
 
 VideoBuffer * SaveRenderer::Render(unsigned char * saveData, int dataSize, bool decorations, bool fire)
 {
-	std::lock_guard<std::mutex> g(renderMutex);
-
 	GameSave * tempSave;
 	try {
 		tempSave = new GameSave((char*)saveData, dataSize);
@@ -182,4 +267,6 @@ VideoBuffer * SaveRenderer::Render(unsigned char * saveData, int dataSize, bool
 
 SaveRenderer::~SaveRenderer()
 {
+	for (auto context : idleContexts)
+		delete context;
 }
@@ -5,7 +5,10 @@
 #include "graphics/OpenGLHeaders.h"
 #endif
 #include "common/Singleton.h"
+#include "common/tpt-rand.h"
+#include <condition_variable>
 #include <mutex>
+#include <vector>
 
 class GameSave;
 class VideoBuffer;
@@ -13,21 +16,56 @@ class Graphics;
 class Simulation;
 class Renderer;
 
+// at most this many saves are rendered at once, each one needs its own
+// Simulation, which is large
+#define SAVERENDERER_MAX_CONTEXTS 8
+
 class SaveRenderer: public Singleton<SaveRenderer> {
-	Graphics * g;
-	Simulation * sim;
-	Renderer * ren;
-	std::mutex renderMutex;
+	// everything one render needs, so several can run on different threads
+	class Context
+	{
+		Graphics * g;
+		Simulation * sim;
+		Renderer * ren;
+#if defined(OGLR) || defined(OGLI)
+		GLuint fboTex, fbo;
+#endif
+	public:
+		// element graphics functions and fire flicker draw from this instead
+		// of the shared generators while the context renders
+		RNG rng;
+
+		Context();
+		~Context();
+		VideoBuffer * Render(GameSave * save, bool decorations, bool fire, Renderer *renderModeSource);
+	};
+
+	// a context taken for one render, returned to the idle ones when the lease
+	// goes out of scope, even if rendering throws
+	class ContextLease
+	{
+		SaveRenderer & saveRenderer;
+	public:
+		Context * context;
+		ContextLease(SaveRenderer & saveRenderer);
+		~ContextLease();
+	};
+
+	// contexts are created as they are needed, up to maxContexts, of which
+	// busyContexts are rendering
+	std::vector<Context *> idleContexts;
+	int busyContexts;
+	int maxContexts;
+	std::mutex contextMutex;
+	std::condition_variable contextAvailable;
+
+	Context * AcquireContext();
+	void ReleaseContext(Context * context);
 public:
 	SaveRenderer();
 	VideoBuffer * Render(GameSave * save, bool decorations = true, bool fire = true, Renderer *renderModeSource = nullptr);
 	VideoBuffer * Render(unsigned char * saveData, int saveDataSize, bool decorations = true, bool fire = true);
 	virtual ~SaveRenderer();
-
-private:
-#if defined(OGLR) || defined(OGLI)
-	GLuint fboTex, fbo;
-#endif
 };
 
 #endif /* SAVERENDERER_H_ */
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 #include <set>
 #ifdef _MSC_VER
 #include <intrin.h>
@@ -12,6 +13,7 @@
 #include "Air.h"
 #include "Config.h"
 #include "CoordStack.h"
+#include "FloodFill.h"
 #include "ElementClasses.h"
 #include "Gravity.h"
 #include "Sample.h"
@@ -51,6 +53,7 @@ int Simulation::Load(GameSave * save, bool includePressure, int fullX, int fullY
 {
 	if (!save)
 		return 1;
+	stackIndexValid = false;
 	try
 	{
 		save->Expand();
@@ -340,9 +343,9 @@ int Simulation::Load(GameSave * save, bool includePressure, int fullX, int fullY
 			signs.push_back(tempSign);
 		}
 	}
-	for(int saveBlockX = 0; saveBlockX < save->blockWidth; saveBlockX++)
+	for(int saveBlockY = 0; saveBlockY < save->blockHeight; saveBlockY++)
 	{
-		for(int saveBlockY = 0; saveBlockY < save->blockHeight; saveBlockY++)
+		for(int saveBlockX = 0; saveBlockX < save->blockWidth; saveBlockX++)
 		{
 			if (!InBounds((saveBlockX + blockX) * CELL, (saveBlockY + blockY) * CELL))
 				continue;
@@ -368,6 +371,7 @@ int Simulation::Load(GameSave * save, bool includePressure, int fullX, int fullY
 
 	gravWallChanged = true;
 	air->RecalculateBlockAirMaps();
+	WakeAllChunks();
 
 	return 0;
 }
@@ -490,9 +494,9 @@ GameSave * Simulation::Save(bool includePressure, int fullX, int fullY, int full
 		}
 	}
 
-	for(int saveBlockX = 0; saveBlockX < newSave->blockWidth; saveBlockX++)
+	for(int saveBlockY = 0; saveBlockY < newSave->blockHeight; saveBlockY++)
 	{
-		for(int saveBlockY = 0; saveBlockY < newSave->blockHeight; saveBlockY++)
+		for(int saveBlockX = 0; saveBlockX < newSave->blockWidth; saveBlockX++)
 		{
 			if(bmap[saveBlockY+blockY][saveBlockX+blockX])
 			{
@@ -611,6 +615,33 @@ void Simulation::Restore(const Snapshot & snap)
 	player = snap.stickmen[snap.stickmen.size()-1];
 	player2 = snap.stickmen[snap.stickmen.size()-2];
 	signs = snap.signs;
+	WakeAllChunks();
+}
+
+void Simulation::CopyRenderState(const Simulation & from)
+{
+	parts_lastActiveIndex = from.parts_lastActiveIndex;
+	std::copy(from.parts, from.parts+parts_lastActiveIndex+1, parts);
+	std::copy(&from.pmap[0][0], &from.pmap[0][0]+XRES*YRES, &pmap[0][0]);
+	std::copy(&from.photons[0][0], &from.photons[0][0]+XRES*YRES, &photons[0][0]);
+	std::copy(&from.pv[0][0], &from.pv[0][0]+((XRES/CELL)*(YRES/CELL)), &pv[0][0]);
+	std::copy(&from.vx[0][0], &from.vx[0][0]+((XRES/CELL)*(YRES/CELL)), &vx[0][0]);
+	std::copy(&from.vy[0][0], &from.vy[0][0]+((XRES/CELL)*(YRES/CELL)), &vy[0][0]);
+	std::copy(&from.hv[0][0], &from.hv[0][0]+((XRES/CELL)*(YRES/CELL)), &hv[0][0]);
+	std::copy(from.gravx, from.gravx+((XRES/CELL)*(YRES/CELL)), gravx);
+	std::copy(from.gravy, from.gravy+((XRES/CELL)*(YRES/CELL)), gravy);
+	std::copy(from.grav->gravmask, from.grav->gravmask+((XRES/CELL)*(YRES/CELL)), grav->gravmask);
+	std::copy(&from.bmap[0][0], &from.bmap[0][0]+((XRES/CELL)*(YRES/CELL)), &bmap[0][0]);
+	std::copy(&from.emap[0][0], &from.emap[0][0]+((XRES/CELL)*(YRES/CELL)), &emap[0][0]);
+	player = from.player;
+	player2 = from.player2;
+	std::copy(&from.fighters[0], &from.fighters[MAX_FIGHTERS], &fighters[0]);
+	signs = from.signs;
+	elements = from.elements;
+	emp_decor = from.emp_decor;
+	aheat_enable = from.aheat_enable;
+	currentTick = from.currentTick;
+	timings.enabled = from.timings.enabled;
 }
 
 void Simulation::clear_area(int area_x, int area_y, int area_w, int area_h)
@@ -633,6 +664,7 @@ void Simulation::clear_area(int area_x, int area_y, int area_w, int area_h)
 			emap[y][x] = 0;
 		}
 	}
+	WakeChunks(area_x, area_y, area_x+area_w, area_y+area_h);
 	for( int i = signs.size()-1; i >= 0; i--)
 	{
 		if (signs[i].text.length() && signs[i].x >= area_x && signs[i].y >= area_y && signs[i].x <= area_x+area_w && signs[i].y <= area_y+area_h)
@@ -661,7 +693,6 @@ CoordStack& Simulation::getCoordStackSingleton()
 
 int Simulation::flood_prop(int x, int y, size_t propoffset, PropertyValue propvalue, StructProperty::PropertyType proptype)
 {
-	int i, x1, x2, dy = 1;
 	int did_something = 0;
 	int r = pmap[y][x];
 	if (!r)
@@ -669,34 +700,18 @@ int Simulation::flood_prop(int x, int y, size_t propoffset, PropertyValue propva
 	if (!r)
 		return 0;
 	int parttype = TYP(r);
-	char * bitmap = (char*)malloc(XRES*YRES); //Bitmap for checking
-	if (!bitmap) return -1;
-	memset(bitmap, 0, XRES*YRES);
+	// Bitmap for checking, setting the property doesn't change what the fill looks for
+	auto bitmapPtr = std::unique_ptr<char[]>(new char[XRES * YRES]());
+	char *bitmap = bitmapPtr.get();
 	try
 	{
-		CoordStack& cs = getCoordStackSingleton();
-		cs.clear();
-
-		cs.push(x, y);
-		do
-		{
-			cs.pop(x, y);
-			x1 = x2 = x;
-			while (x1>=CELL)
-			{
-				if (!FloodFillPmapCheck(x1-1, y, parttype) || bitmap[(y*XRES)+x1-1])
-					break;
-				x1--;
-			}
-			while (x2<XRES-CELL)
+		FloodFill fill(getCoordStackSingleton(), CELL-1, CELL, XRES-CELL, YRES-CELL-1);
+		fill.Run(x, y, [this, bitmap, parttype](int x, int y) {
+			return !bitmap[(y*XRES)+x] && FloodFillPmapCheck(x, y, parttype);
+		}, [&](int x1, int x2, int y) {
+			for (int x=x1; x<=x2; x++)
 			{
-				if (!FloodFillPmapCheck(x2+1, y, parttype) || bitmap[(y*XRES)+x2+1])
-					break;
-				x2++;
-			}
-			for (x=x1; x<=x2; x++)
-			{
-				i = pmap[y][x];
+				int i = pmap[y][x];
 				if (!i)
 					i = photons[y][x];
 				if (!i)
@@ -721,23 +736,14 @@ int Simulation::flood_prop(int x, int y, size_t propoffset, PropertyValue propva
 				bitmap[(y*XRES)+x] = 1;
 				did_something = 1;
 			}
-			if (y>=CELL+dy)
-				for (x=x1; x<=x2; x++)
-					if (FloodFillPmapCheck(x, y-dy, parttype) && !bitmap[((y-dy)*XRES)+x])
-						cs.push(x, y-dy);
-			if (y<YRES-CELL-dy)
-				for (x=x1; x<=x2; x++)
-					if (FloodFillPmapCheck(x, y+dy, parttype) && !bitmap[((y+dy)*XRES)+x])
-						cs.push(x, y+dy);
-		} while (cs.getSize()>0);
+			return true;
+		});
 	}
 	catch (std::exception& e)
 	{
 		std::cerr << e.what() << std::endl;
-		free(bitmap);
 		return -1;
 	}
-	free(bitmap);
 	return did_something;
 }
 
@@ -755,17 +761,14 @@ void Simulation::UpdateSample(int x, int y)
 		int maxStackSample = stackEditDepth + 3;
 		if (maxStackSample < 5)
 			maxStackSample = 5;
-		for (int i = parts_lastActiveIndex; i >= 0; i--)
+		if (stackSampleX >= 0 && stackSampleX < XRES && stackSampleY >= 0 && stackSampleY < YRES)
 		{
-			if (!parts[i].type)
-				continue;
-			int partx = (int)(parts[i].x+0.5f);
-			int party = (int)(parts[i].y+0.5f);
-			if (partx != stackSampleX || party != stackSampleY)
-				continue;
-			if (sample.SParticleCount < maxStackSample)
-				stackIds[sample.SParticleCount % 5] = i;
-			sample.SParticleCount++;
+			for (int i = StackIndexHead(stackSampleX, stackSampleY); i >= 0; i = stackIndexNext[i])
+			{
+				if (sample.SParticleCount < maxStackSample)
+					stackIds[sample.SParticleCount % 5] = i;
+				sample.SParticleCount++;
+			}
 		}
 		sample.StackIndexEnd = sample.SParticleCount;
 		if (sample.StackIndexEnd > maxStackSample)
@@ -839,7 +842,6 @@ void Simulation::UpdateSample(int x, int y)
 
 int Simulation::FloodINST(int x, int y)
 {
-	int x1, x2;
 	int created_something = 0;
 
 	const auto isSparkableInst = [this](int x, int y) -> bool {
@@ -853,34 +855,17 @@ int Simulation::FloodINST(int x, int y)
 	if (!isSparkableInst(x,y))
 		return 1;
 
-	CoordStack& cs = getCoordStackSingleton();
-	cs.clear();
-
-	cs.push(x, y);
-
 	try
 	{
-		do
-		{
-			cs.pop(x, y);
-			x1 = x2 = x;
-			// go left as far as possible
-			while (x1>=CELL && isSparkableInst(x1-1, y))
-			{
-				x1--;
-			}
-			// go right as far as possible
-			while (x2<XRES-CELL && isSparkableInst(x2+1, y))
-			{
-				x2++;
-			}
-			// fill span
-			for (x=x1; x<=x2; x++)
+		FloodFill fill(getCoordStackSingleton(), CELL-1, CELL, XRES-CELL, YRES-CELL-1);
+		fill.Run(x, y, isSparkableInst, [this, &created_something](int x1, int x2, int y) {
+			for (int x=x1; x<=x2; x++)
 			{
 				if (create_part(-1, x, y, PT_SPRK)>=0)
 					created_something = 1;
 			}
-
+			return true;
+		}, [&](int x1, int x2, int y) {
 			// add vertically adjacent pixels to stack
 			// (wire crossing for INST)
 			if (y>=CELL+1 && x1==x2 &&
@@ -889,23 +874,14 @@ int Simulation::FloodINST(int x, int y)
 			{
 				// travelling vertically up, skipping a horizontal line
 				if (isSparkableInst(x1, y-2))
-				{
-						cs.push(x1, y-2);
-				}
+					fill.Push(x1, y-2);
 			}
-			else if (y>=CELL+1)
+			else
 			{
-				for (x=x1; x<=x2; x++)
-				{
-					if (isSparkableInst(x, y-1))
-					{
-						if (x==x1 || x==x2 || y>=YRES-CELL-1 || !isInst(x, y+1) || isInst(x+1, y+1) || isInst(x-1, y+1))
-						{
-							// if at the end of a horizontal section, or if it's a T junction or not a 1px wire crossing
-							cs.push(x, y-1);
-						}
-					}
-				}
+				fill.SeedRuns(x1, x2, y-1, [&](int x, int ny) {
+					// if at the end of a horizontal section, or if it's a T junction or not a 1px wire crossing
+					return isSparkableInst(x, ny) && (x==x1 || x==x2 || y>=YRES-CELL-1 || !isInst(x, y+1) || isInst(x+1, y+1) || isInst(x-1, y+1));
+				});
 			}
 
 			if (y<YRES-CELL-1 && x1==x2 &&
@@ -914,26 +890,15 @@ int Simulation::FloodINST(int x, int y)
 			{
 				// travelling vertically down, skipping a horizontal line
 				if (isSparkableInst(x1, y+2))
-				{
-					cs.push(x1, y+2);
-				}
+					fill.Push(x1, y+2);
 			}
-			else if (y<YRES-CELL-1)
+			else
 			{
-				for (x=x1; x<=x2; x++)
-				{
-					if (isSparkableInst(x, y+1))
-					{
-						if (x==x1 || x==x2 || y<0 || !isInst(x, y-1) || isInst(x+1, y-1) || isInst(x-1, y-1))
-						{
-							// if at the end of a horizontal section, or if it's a T junction or not a 1px wire crossing
-							cs.push(x, y+1);
-						}
-
-					}
-				}
+				fill.SeedRuns(x1, x2, y+1, [&](int x, int ny) {
+					return isSparkableInst(x, ny) && (x==x1 || x==x2 || y<0 || !isInst(x, y-1) || isInst(x+1, y-1) || isInst(x-1, y-1));
+				});
 			}
-		} while (cs.getSize()>0);
+		});
 	}
 	catch (std::exception& e)
 	{
@@ -946,40 +911,25 @@ int Simulation::FloodINST(int x, int y)
 
 bool Simulation::flood_water(int x, int y, int i)
 {
-	int x1, x2, originalY = y;
+	int originalY = y;
 	int r = pmap[y][x];
 	if (!r)
 		return false;
 
 	// Bitmap for checking where we've already looked
-	auto bitmapPtr = std::unique_ptr<char[]>(new char[XRES * YRES]);
+	auto bitmapPtr = std::unique_ptr<char[]>(new char[XRES * YRES]());
 	char *bitmap = bitmapPtr.get();
-	std::fill(&bitmap[0], &bitmap[XRES * YRES], 0);
 
 	try
 	{
-		CoordStack& cs = getCoordStackSingleton();
-		cs.clear();
-
-		cs.push(x, y);
-		do
-		{
-			cs.pop(x, y);
-			x1 = x2 = x;
-			while (x1 >= CELL)
-			{
-				if (elements[TYP(pmap[y][x1 - 1])].Falldown != 2 || bitmap[(y * XRES) + x1 - 1])
-					break;
-				x1--;
-			}
-			while (x2 < XRES-CELL)
-			{
-				if (elements[TYP(pmap[y][x2 + 1])].Falldown != 2 || bitmap[(y * XRES) + x1 - 1])
-					break;
-				x2++;
-			}
+		FloodFill fill(getCoordStackSingleton(), CELL - 1, CELL, XRES - CELL, YRES - CELL - 1);
+		// stops the fill as soon as the particle has been moved
+		return !fill.Run(x, y, [this, bitmap](int x, int y) {
+			return !bitmap[(y * XRES) + x] && elements[TYP(pmap[y][x])].Falldown == 2;
+		}, [this, bitmap, i, originalY](int x1, int x2, int y) {
 			for (int x = x1; x <= x2; x++)
 			{
+				bitmap[(y * XRES) + x] = 1;
 				if ((y - 1) > originalY && !pmap[y - 1][x])
 				{
 					// Try to move the water to a random position on this line, because there's probably a free location somewhere
@@ -996,27 +946,17 @@ bool Simulation::flood_water(int x, int y, int i)
 					pmap[oldy][oldx] = 0;
 					parts[i].x = float(x);
 					parts[i].y = float(y - 1);
-					return true;
+					return false;
 				}
-
-				bitmap[(y * XRES) + x] = 1;
 			}
-			if (y >= CELL + 1)
-				for (int x = x1; x <= x2; x++)
-					if (elements[TYP(pmap[y - 1][x])].Falldown == 2 && !bitmap[((y - 1) * XRES) + x])
-						cs.push(x, y - 1);
-			if (y < YRES - CELL - 1)
-				for (int x = x1; x <= x2; x++)
-					if (elements[TYP(pmap[y + 1][x])].Falldown == 2 && !bitmap[((y + 1) * XRES) + x])
-						cs.push(x, y + 1);
-		} while (cs.getSize() > 0);
+			return true;
+		});
 	}
 	catch (std::exception &e)
 	{
 		std::cerr << e.what() << std::endl;
 		return false;
 	}
-	return false;
 }
 
 void Simulation::SetDecoSpace(int newDecoSpace)
@@ -1363,70 +1303,30 @@ bool Simulation::ColorCompare(Renderer *ren, int x, int y, int replaceR, int rep
 
 void Simulation::ApplyDecorationFill(Renderer *ren, int x, int y, int colR, int colG, int colB, int colA, int replaceR, int replaceG, int replaceB)
 {
-	int x1, x2;
-	char *bitmap = (char*)malloc(XRES*YRES); //Bitmap for checking
-	if (!bitmap)
+	if (!ColorCompare(ren, x, y, replaceR, replaceG, replaceB))
 		return;
-	memset(bitmap, 0, XRES*YRES);
-
-	if (!ColorCompare(ren, x, y, replaceR, replaceG, replaceB)) {
-		free(bitmap);
-		return;
-	}
 
+	// Bitmap for checking, the fill is compared against the last rendered frame
+	auto bitmapPtr = std::unique_ptr<char[]>(new char[XRES * YRES]());
+	char *bitmap = bitmapPtr.get();
 	try
 	{
-		CoordStack& cs = getCoordStackSingleton();
-		cs.clear();
-		
-		cs.push(x, y);
-		do
-		{
-			cs.pop(x, y);
-			x1 = x2 = x;
-			// go left as far as possible
-			while (x1>0)
-			{
-				if (bitmap[(x1-1)+y*XRES] || !ColorCompare(ren, x1-1, y, replaceR, replaceG, replaceB))
-				{
-					break;
-				}
-				x1--;
-			}
-			// go right as far as possible
-			while (x2<XRES-1)
-			{
-				if (bitmap[(x1+1)+y*XRES] || !ColorCompare(ren, x2+1, y, replaceR, replaceG, replaceB))
-				{
-					break;
-				}
-				x2++;
-			}
-			// fill span
-			for (x=x1; x<=x2; x++)
+		FloodFill fill(getCoordStackSingleton(), 0, 0, XRES-1, YRES-1);
+		fill.Run(x, y, [this, ren, bitmap, replaceR, replaceG, replaceB](int x, int y) {
+			return !bitmap[x+y*XRES] && ColorCompare(ren, x, y, replaceR, replaceG, replaceB);
+		}, [&](int x1, int x2, int y) {
+			for (int x=x1; x<=x2; x++)
 			{
 				ApplyDecoration(x, y, colR, colG, colB, colA, DECO_DRAW);
 				bitmap[x+y*XRES] = 1;
 			}
-
-			if (y >= 1)
-				for (x=x1; x<=x2; x++)
-					if (!bitmap[x+(y-1)*XRES] && ColorCompare(ren, x, y-1, replaceR, replaceG, replaceB))
-						cs.push(x, y-1);
-
-			if (y < YRES-1)
-				for (x=x1; x<=x2; x++)
-					if (!bitmap[x+(y+1)*XRES] && ColorCompare(ren, x, y+1, replaceR, replaceG, replaceB))
-						cs.push(x, y+1);
-		} while (cs.getSize() > 0);
+			return true;
+		});
 	}
 	catch (std::exception& e)
 	{
 		std::cerr << e.what() << std::endl;
-		free(bitmap);
-		return;
 	}
-	free(bitmap);
 }
 #endif
 
@@ -1439,6 +1339,9 @@ int Simulation::Tool(int x, int y, int tool, int brushX, int brushY, float stren
 	else if ((r = photons[y][x]))
 		cpart = &(parts[ID(r)]);
 	needReloadParticleOrder = true;
+	stackIndexValid = false;
+	if (chunk_sleep)
+		WakeChunk(x, y);
 	return tools[tool].Perform(this, cpart, x, y, brushX, brushY, strength);
 }
 
@@ -1587,6 +1490,7 @@ int Simulation::CreateWalls(int x, int y, int rx, int ry, int wall, Brush * cBru
 				}
 				else
 					bmap[wallY][wallX] = wall;
+				WakeChunks(wallX*CELL, wallY*CELL, wallX*CELL+CELL-1, wallY*CELL+CELL-1);
 			}
 		}
 	}
@@ -1668,7 +1572,6 @@ void Simulation::CreateWallBox(int x1, int y1, int x2, int y2, int wall)
 
 int Simulation::FloodWalls(int x, int y, int wall, int bm)
 {
-	int x1, x2, dy = CELL;
 	if (bm==-1)
 	{
 		if (wall==WL_ERASE || wall==WL_ERASEALL)
@@ -1684,43 +1587,29 @@ int Simulation::FloodWalls(int x, int y, int wall, int bm)
 	if (bmap[y/CELL][x/CELL]!=bm)
 		return 1;
 
-	// go left as far as possible
-	x1 = x2 = x;
-	while (x1>=CELL)
-	{
-		if (bmap[y/CELL][(x1-1)/CELL]!=bm)
-		{
-			break;
-		}
-		x1--;
-	}
-	while (x2<XRES-CELL)
+	// walls are filled a cell at a time; CreateWalls doesn't always change the
+	// cell (streamlines next to each other), so filled cells are also tracked
+	char filled[YRES/CELL][XRES/CELL] = {};
+	try
 	{
-		if (bmap[y/CELL][(x2+1)/CELL]!=bm)
-		{
-			break;
-		}
-		x2++;
+		FloodFill fill(getCoordStackSingleton(), 0, 0, XRES/CELL-1, YRES/CELL-1);
+		return fill.Run(x/CELL, y/CELL, [this, &filled, bm](int x, int y) {
+			return !filled[y][x] && bmap[y][x]==bm;
+		}, [this, &filled, wall](int x1, int x2, int y) {
+			for (int x=x1; x<=x2; x++)
+			{
+				if (!CreateWalls(x*CELL, y*CELL, 0, 0, wall, NULL))
+					return false;
+				filled[y][x] = 1;
+			}
+			return true;
+		}) ? 1 : 0;
 	}
-
-	// fill span
-	for (x=x1; x<=x2; x++)
+	catch (std::exception& e)
 	{
-		if (!CreateWalls(x, y, 0, 0, wall, NULL))
-			return 0;
+		std::cerr << e.what() << std::endl;
+		return 0;
 	}
-	// fill children
-	if (y>=CELL)
-		for (x=x1; x<=x2; x++)
-			if (bmap[(y-dy)/CELL][x/CELL]==bm)
-				if (!FloodWalls(x, y-dy, wall, bm))
-					return 0;
-	if (y<YRES-CELL)
-		for (x=x1; x<=x2; x++)
-			if (bmap[(y+dy)/CELL][x/CELL]==bm)
-				if (!FloodWalls(x, y+dy, wall, bm))
-					return 0;
-	return 1;
 }
 
 #ifndef RENDERER
@@ -2001,10 +1890,7 @@ void Simulation::CreateBox(int x1, int y1, int x2, int y2, int c, int flags)
 int Simulation::FloodParts(int x, int y, int fullc, int cm, int flags)
 {
 	int c = TYP(fullc);
-	int x1, x2, dy = (c<PT_NUM)?1:CELL;
-	int coord_stack_limit = XRES*YRES;
-	unsigned short (*coord_stack)[2];
-	int coord_stack_size = 0;
+	int dy = (c<PT_NUM)?1:CELL;
 	int created_something = 0;
 
 	if (cm==-1)
@@ -2040,87 +1926,43 @@ int Simulation::FloodParts(int x, int y, int fullc, int cm, int flags)
 	if (!FloodFillPmapCheck(x, y, cm))
 		return 1;
 
-	coord_stack = (short unsigned int (*)[2])malloc(sizeof(unsigned short)*2*coord_stack_limit);
-	coord_stack[coord_stack_size][0] = x;
-	coord_stack[coord_stack_size][1] = y;
-	coord_stack_size++;
-
-	do
+	// not the shared stack, creating particles can run Lua callbacks that flood fill again
+	CoordStack cs;
+	try
 	{
-		coord_stack_size--;
-		x = coord_stack[coord_stack_size][0];
-		y = coord_stack[coord_stack_size][1];
-		x1 = x2 = x;
-		// go left as far as possible
-		while (c?x1>CELL:x1>0)
-		{
-			if (!FloodFillPmapCheck(x1-1, y, cm) || (c != 0 && IsWallBlocking(x1-1, y, c)))
-			{
-				break;
-			}
-			x1--;
-		}
-		// go right as far as possible
-		while (c?x2<XRES-CELL-1:x2<XRES-1)
-		{
-			if (!FloodFillPmapCheck(x2+1, y, cm) || (c != 0 && IsWallBlocking(x2+1, y, c)))
+		FloodFill fill(cs, c ? CELL : 0, c ? CELL : 0, c ? XRES-CELL-1 : XRES-1, c ? YRES-CELL-1 : YRES-1, dy);
+		fill.Run(x, y, [this, c, cm](int x, int y) {
+			return FloodFillPmapCheck(x, y, cm) && (c == 0 || !IsWallBlocking(x, y, c));
+		}, [&](int x1, int x2, int y) {
+			for (int x=x1; x<=x2; x++)
 			{
-				break;
-			}
-			x2++;
-		}
-		// fill span
-		for (x=x1; x<=x2; x++)
-		{
-			if (!fullc)
-			{
-				if (elements[cm].Properties&TYPE_ENERGY)
+				if (!fullc)
 				{
-					if (photons[y][x])
+					if (elements[cm].Properties&TYPE_ENERGY)
+					{
+						if (photons[y][x])
+						{
+							kill_part(ID(photons[y][x]));
+							created_something = 1;
+						}
+					}
+					else if (pmap[y][x])
 					{
-						kill_part(ID(photons[y][x]));
+						kill_part(ID(pmap[y][x]));
 						created_something = 1;
 					}
 				}
-				else if (pmap[y][x])
-				{
-					kill_part(ID(pmap[y][x]));
+				else if (CreateParts(x, y, 0, 0, fullc, flags))
 					created_something = 1;
-				}
 			}
-			else if (CreateParts(x, y, 0, 0, fullc, flags))
-				created_something = 1;
-		}
-
-		if (c?y>=CELL+dy:y>=dy)
-			for (x=x1; x<=x2; x++)
-				if (FloodFillPmapCheck(x, y-dy, cm) && (c == 0 || !IsWallBlocking(x, y-dy, c)))
-				{
-					coord_stack[coord_stack_size][0] = x;
-					coord_stack[coord_stack_size][1] = y-dy;
-					coord_stack_size++;
-					if (coord_stack_size>=coord_stack_limit)
-					{
-						free(coord_stack);
-						return -1;
-					}
-				}
-
-		if (c?y<YRES-CELL-dy:y<YRES-dy)
-			for (x=x1; x<=x2; x++)
-				if (FloodFillPmapCheck(x, y+dy, cm) && (c == 0 || !IsWallBlocking(x, y+dy, c)))
-				{
-					coord_stack[coord_stack_size][0] = x;
-					coord_stack[coord_stack_size][1] = y+dy;
-					coord_stack_size++;
-					if (coord_stack_size>=coord_stack_limit)
-					{
-						free(coord_stack);
-						return -1;
-					}
-				}
-	} while (coord_stack_size>0);
-	free(coord_stack);
+			return true;
+		});
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return -1;
+	}
 	return created_something;
 }
 #endif
@@ -2254,6 +2096,7 @@ void Simulation::set_emap(int x, int y)
 	// fill span
 	for (x=x1; x<=x2; x++)
 		emap[y][x] = 16;
+	WakeChunks(x1*CELL, y*CELL, x2*CELL+CELL-1, y*CELL+CELL-1);
 
 	// fill children
 
@@ -2350,6 +2193,7 @@ void Simulation::clear_sim(void)
 {
 	debug_currentParticle = 0;
 	needReloadParticleOrder = false;
+	stackIndexValid = false;
 	emp_decor = 0;
 	emp_trigger_count = 0;
 	signs.clear();
@@ -2371,6 +2215,10 @@ void Simulation::clear_sim(void)
 	memset(fighters, 0, sizeof(fighters));
 	std::fill(elementCount, elementCount+PT_NUM, 0);
 	elementRecount = true;
+	for (int t = 0; t < PT_NUM; t++)
+		ClearBounds(elementBounds[t]);
+	ClearBounds(stackingBounds);
+	SetChunkSleep(chunk_sleep);
 	fighcount = 0;
 	player.spwn = 0;
 	player.spawnID = -1;
@@ -3159,6 +3007,7 @@ void Simulation::kill_part(int i)//kills particle number i
 		return;
 
 	debug_interestingChangeOccurred = true;
+	stackIndexValid = false;
 	
 	int x = (int)(parts[i].x + 0.5f);
 	int y = (int)(parts[i].y + 0.5f);
@@ -3196,6 +3045,8 @@ bool Simulation::part_change_type(int i, int x, int y, int t)
 
 	if (x<0 || y<0 || x>=XRES || y>=YRES || i>=NPART || t<0 || t>=PT_NUM || !parts[i].type)
 		return false;
+	if (chunk_sleep)
+		WakeChunk(x, y);
 	if (!elements[t].Enabled || t == PT_NONE)
 	{
 		kill_part(i);
@@ -3238,9 +3089,12 @@ int Simulation::create_part(int p, int x, int y, int t, int v)
 {
 	int i, oldType = PT_NONE;
 	debug_interestingChangeOccurred = true;
+	stackIndexValid = false;
 
 	if (x<0 || y<0 || x>=XRES || y>=YRES || t<=0 || t>=PT_NUM || !elements[t].Enabled)
 		return -1;
+	if (chunk_sleep)
+		WakeChunk(x, y);
 
 	if (t == PT_SPRK && !(p == -2 && elements[TYP(pmap[y][x])].CtypeDraw))
 	{
@@ -3559,7 +3413,9 @@ void Simulation::UpdateParticles(int start, int end)
 	float pGravX, pGravY, pGravD;
 	bool transitionOccurred;
 
+	SimulationTimings::Scope scope(timings, SimulationTimings::PHASE_PARTICLES);
 	debug_interestingChangeOccurred = false;
+	stackIndexValid = false;
 
 	//the main particle loop function, goes over all particles.
 	for (i = start; i <= end && i <= parts_lastActiveIndex; i++)
@@ -3592,6 +3448,10 @@ void Simulation::UpdateParticles(int start, int end)
 				continue;
 			}
 
+			// nor ones in sleeping chunks, except stickmen which can be moved without anything changing around them
+			if (chunk_sleep && ChunkAsleep(x/SLEEPCHUNK, y/SLEEPCHUNK) && t!=PT_STKM && t!=PT_STKM2 && t!=PT_FIGH)
+				continue;
+
 			if (bmap[y/CELL][x/CELL]==WL_DETECT && emap[y/CELL][x/CELL]<8)
 				set_emap(x/CELL, y/CELL);
 
@@ -3720,7 +3580,16 @@ void Simulation::UpdateParticles(int start, int end)
 #ifdef REALISTIC
 				if (t&&(t!=PT_HSWC||parts[i].life==10)&&(elements[t].HeatConduct*gel_scale))
 #else
-				if (t && (t!=PT_HSWC||parts[i].life==10) && RNG::Ref().chance(int(elements[t].HeatConduct*gel_scale), 250))
+				bool conductHeat;
+				if (parallel_heat)
+				{
+					// ConductHeat already decided this and did the neighbour averaging
+					conductHeat = heatConducted[i];
+					heatConducted[i] = 0;
+				}
+				else
+					conductHeat = t && (t!=PT_HSWC||parts[i].life==10) && RNG::Ref().chance(int(elements[t].HeatConduct*gel_scale), 250);
+				if (conductHeat)
 #endif
 				{
 					if (aheat_enable && !(elements[t].Properties&PROP_NOAMBHEAT))
@@ -3745,20 +3614,14 @@ void Simulation::UpdateParticles(int start, int end)
 #ifdef REALISTIC
 					float c_Cm = 0.0f;
 #endif
-					for (j=0; j<8; j++)
+					for (j=0; j<8 && !parallel_heat; j++)
 					{
 						surround_hconduct[j] = i;
 						r = surround[j];
 						if (!r)
 							continue;
 						rt = TYP(r);
-						if (rt && elements[rt].HeatConduct && (rt!=PT_HSWC||parts[ID(r)].life==10)
-						        && (t!=PT_FILT||(rt!=PT_BRAY&&rt!=PT_BIZR&&rt!=PT_BIZRG))
-						        && (rt!=PT_FILT||(t!=PT_BRAY&&t!=PT_PHOT&&t!=PT_BIZR&&t!=PT_BIZRG))
-						        && (t!=PT_ELEC||rt!=PT_DEUT)
-						        && (t!=PT_DEUT||rt!=PT_ELEC)
-						        && (t!=PT_HSWC || rt!=PT_FILT || parts[i].tmp != 1)
-						        && (t!=PT_FILT || rt!=PT_HSWC || parts[ID(r)].tmp != 1))
+						if (HeatConducts(t, i, r))
 						{
 							surround_hconduct[j] = ID(r);
 #ifdef REALISTIC
@@ -3790,9 +3653,12 @@ void Simulation::UpdateParticles(int start, int end)
 #else
 					pt = (c_heat+parts[i].temp)/(h_count+1);
 					pt = parts[i].temp = restrict_flt(pt, MIN_TEMP, MAX_TEMP);
-					for (j=0; j<8; j++)
+					if (!parallel_heat)
 					{
-						parts[surround_hconduct[j]].temp = pt;
+						for (j=0; j<8; j++)
+						{
+							parts[surround_hconduct[j]].temp = pt;
+						}
 					}
 #endif
 
@@ -4183,40 +4049,46 @@ void Simulation::UpdateParticles(int start, int end)
 			}
 
 			//call the particle update function, if there is one
-#if !defined(RENDERER) && defined(LUACONSOLE)
-			if (lua_el_mode[parts[i].type] == 3)
 			{
-				if (luacon_elementReplacement(this, i, x, y, surround_space, nt, parts, pmap) || t != parts[i].type)
-					continue;
-				// Need to update variables, in case they've been changed by Lua
-				x = (int)(parts[i].x+0.5f);
-				y = (int)(parts[i].y+0.5f);
-			}
+				// Lua time is counted both in the element total and on its own
+				SimulationTimings::ElementScope elementScope(timings, t);
+#if !defined(RENDERER) && defined(LUACONSOLE)
+				if (lua_el_mode[parts[i].type] == 3)
+				{
+					SimulationTimings::ElementScope luaScope(timings, t, true);
+					if (luacon_elementReplacement(this, i, x, y, surround_space, nt, parts, pmap) || t != parts[i].type)
+						continue;
+					// Need to update variables, in case they've been changed by Lua
+					x = (int)(parts[i].x+0.5f);
+					y = (int)(parts[i].y+0.5f);
+				}
 
-			if (elements[t].Update && lua_el_mode[t] != 2)
+				if (elements[t].Update && lua_el_mode[t] != 2)
 #else
-			if (elements[t].Update)
+				if (elements[t].Update)
 #endif
-			{
-				if ((*(elements[t].Update))(this, i, x, y, surround_space, nt, parts, pmap))
-					continue;
-				else if (t==PT_WARP)
 				{
-					// Warp does some movement in its update func, update variables to avoid incorrect data in pmap
+					if ((*(elements[t].Update))(this, i, x, y, surround_space, nt, parts, pmap))
+						continue;
+					else if (t==PT_WARP)
+					{
+						// Warp does some movement in its update func, update variables to avoid incorrect data in pmap
+						x = (int)(parts[i].x+0.5f);
+						y = (int)(parts[i].y+0.5f);
+					}
+				}
+#if !defined(RENDERER) && defined(LUACONSOLE)
+				if (lua_el_mode[parts[i].type] && lua_el_mode[parts[i].type] != 3)
+				{
+					SimulationTimings::ElementScope luaScope(timings, t, true);
+					if (luacon_elementReplacement(this, i, x, y, surround_space, nt, parts, pmap) || t != parts[i].type)
+						continue;
+					// Need to update variables, in case they've been changed by Lua
 					x = (int)(parts[i].x+0.5f);
 					y = (int)(parts[i].y+0.5f);
 				}
-			}
-#if !defined(RENDERER) && defined(LUACONSOLE)
-			if (lua_el_mode[parts[i].type] && lua_el_mode[parts[i].type] != 3)
-			{
-				if (luacon_elementReplacement(this, i, x, y, surround_space, nt, parts, pmap) || t != parts[i].type)
-					continue;
-				// Need to update variables, in case they've been changed by Lua
-				x = (int)(parts[i].x+0.5f);
-				y = (int)(parts[i].y+0.5f);
-			}
 #endif
+			}
 
 			if(legacy_enable)//if heat sim is off
 				Element::legacyUpdate(this, i,x,y,surround_space,nt, parts, pmap);
@@ -4819,15 +4691,35 @@ int Simulation::GetParticleType(ByteString type)
 	return -1;
 }
 
+inline void Simulation::ClearBounds(int *bounds)
+{
+	bounds[0] = XRES;
+	bounds[1] = YRES;
+	bounds[2] = -1;
+	bounds[3] = -1;
+}
+
+inline void Simulation::ExtendBounds(int *bounds, int x, int y)
+{
+	if (x < bounds[0]) bounds[0] = x;
+	if (y < bounds[1]) bounds[1] = y;
+	if (x > bounds[2]) bounds[2] = x;
+	if (y > bounds[3]) bounds[3] = y;
+}
+
 void Simulation::RecalcFreeParticles(bool do_life_dec)
 {
 	int x, y, t;
 	int lastPartUsed = 0;
 	int lastPartUnused = -1;
 
+	stackIndexValid = false;
 	memset(pmap, 0, sizeof(pmap));
 	memset(pmap_count, 0, sizeof(pmap_count));
 	memset(photons, 0, sizeof(photons));
+	for (int t = 0; t < PT_NUM; t++)
+		ClearBounds(elementBounds[t]);
+	ClearBounds(stackingBounds);
 
 	NUM_PARTS = 0;
 	//the particle loop that resets the pmap/photon maps every frame, to update them.
@@ -4851,8 +4743,14 @@ void Simulation::RecalcFreeParticles(bool do_life_dec)
 						pmap[y][x] = PMAP(i, t);
 					// (there are a few exceptions, including energy particles - currently no limit on stacking those)
 					if (t!=PT_THDR && t!=PT_EMBR && t!=PT_FIGH && t!=PT_PLSM)
+					{
 						pmap_count[y][x]++;
+						if (pmap_count[y][x] == 6)
+							ExtendBounds(stackingBounds, x, y);
+					}
 				}
+				if (t >= 0 && t < PT_NUM)
+					ExtendBounds(elementBounds[t], x, y);
 				inBounds = true;
 			}
 			lastPartUsed = i;
@@ -4916,6 +4814,27 @@ void Simulation::RecalcFreeParticles(bool do_life_dec)
 		elementRecount = false;
 }
 
+void Simulation::BuildStackIndex()
+{
+	if (stackIndexValid)
+		return;
+	memset(stackIndexHead, 0xFF, sizeof(stackIndexHead));
+	// going up through the IDs leaves the highest one at the head of each list,
+	// the order UpdateSample and the stack edit depth count in
+	for (int i = 0; i <= parts_lastActiveIndex; i++)
+	{
+		if (!parts[i].type)
+			continue;
+		int x = (int)(parts[i].x+0.5f);
+		int y = (int)(parts[i].y+0.5f);
+		if (x < 0 || x >= XRES || y < 0 || y >= YRES)
+			continue;
+		stackIndexNext[i] = stackIndexHead[y][x];
+		stackIndexHead[y][x] = i;
+	}
+	stackIndexValid = true;
+}
+
 void Simulation::FixSoapLinks(std::map<unsigned int, unsigned int> &soapList)
 {
 	// fix SOAP links using soapList, a map of old particle ID -> new particle ID
@@ -4942,9 +4861,103 @@ void Simulation::FixSoapLinks(std::map<unsigned int, unsigned int> &soapList)
 	}
 }
 
+// Sorts only the end of the particle list, starting from the first particle that
+// is out of place, and returns false if a full reload is needed instead
+bool Simulation::ReloadParticleOrderIncremental()
+{
+	int lastIndex = parts_lastActiveIndex;
+	auto key = [this](int i) {
+		return (int)(parts[i].y+0.5f) * XRES + (int)(parts[i].x+0.5f);
+	};
+	auto inBounds = [this](int i) {
+		int partx = (int)(parts[i].x+0.5f);
+		int party = (int)(parts[i].y+0.5f);
+		return !(partx<CELL || partx>=XRES-CELL || party<CELL || party>=YRES-CELL);
+	};
+
+	// the start of the list that is already in order and has no holes
+	int sortedEnd = 0;
+	for (int prevKey = -1; sortedEnd <= lastIndex; sortedEnd++)
+	{
+		if (!parts[sortedEnd].type || !inBounds(sortedEnd))
+			break;
+		int k = key(sortedEnd);
+		if (k < prevKey)
+			break;
+		prevKey = k;
+	}
+	// out of bounds particles are killed by the full reload, leave that to it
+	if (sortedEnd <= lastIndex && parts[sortedEnd].type && !inBounds(sortedEnd))
+		return false;
+
+	std::vector<std::pair<int, int> > moved; // position key, old ID
+	int minKey = XRES*YRES;
+	for (int i = sortedEnd; i <= lastIndex; i++)
+	{
+		if (!parts[i].type)
+			continue;
+		if (!inBounds(i))
+			return false;
+		moved.push_back(std::make_pair(key(i), i));
+		minKey = std::min(minKey, moved.back().first);
+	}
+
+	// particles in the sorted part that belong after the smallest out of place one have to move too
+	int start = sortedEnd;
+	{
+		int lo = 0, hi = sortedEnd;
+		while (lo < hi)
+		{
+			int mid = (lo + hi) / 2;
+			if (key(mid) > minKey)
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		start = lo;
+	}
+	std::vector<std::pair<int, int> > tail;
+	for (int i = start; i < sortedEnd; i++)
+		tail.push_back(std::make_pair(key(i), i));
+	moved.insert(moved.begin(), tail.begin(), tail.end());
+	// stable, so particles on the same pixel keep their order
+	std::stable_sort(moved.begin(), moved.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) {
+		return a.first < b.first;
+	});
+
+	std::map<unsigned int, unsigned int> soapList;
+	for (int k = 0; k < (int)moved.size(); k++)
+	{
+		int i = moved[k].second;
+		stackReorderParts[k] = parts[i];
+		if (parts[i].type == PT_SOAP)
+			soapList.insert(std::pair<unsigned int, unsigned int>(i, start + k));
+	}
+	if (moved.size())
+		memcpy(&parts[start], stackReorderParts, sizeof(Particle) * moved.size());
+	int end = start + int(moved.size());
+	if (end <= lastIndex)
+		memset(&parts[end], 0, sizeof(Particle) * (lastIndex + 1 - end));
+	if (soapList.size())
+	{
+		// SOAP that didn't move may still link to SOAP that did
+		for (int i = 0; i < start; i++)
+			if (parts[i].type == PT_SOAP)
+				soapList.insert(std::pair<unsigned int, unsigned int>(i, i));
+		FixSoapLinks(soapList);
+	}
+	RecalcFreeParticles(false);
+	return true;
+}
+
 void Simulation::ReloadParticleOrder()
 {
 	CompleteDebugUpdateParticles();
+	if (ReloadParticleOrderIncremental())
+	{
+		needReloadParticleOrder = false;
+		return;
+	}
 	// use pmap_count as count buffer
 	memset(pmap_count, 0, sizeof(pmap_count));
 	memset(stackReorderParts, 0, sizeof(stackReorderParts));
@@ -4995,7 +5008,7 @@ void Simulation::BeforeStackEdit()
 	CompleteDebugUpdateParticles();
 	// use pmap_count as count buffer
 	memset(pmap_count, 0, sizeof(pmap_count));
-	memset(stackReorderParts, 0, sizeof(stackReorderParts));
+	int oldLastActiveIndex = parts_lastActiveIndex;
 	int numInBack = 0;
 	for (int i = parts_lastActiveIndex; i >= 0; i--)
 	{
@@ -5004,7 +5017,11 @@ void Simulation::BeforeStackEdit()
 		int partx = (int)(parts[i].x+0.5f);
 		int party = (int)(parts[i].y+0.5f);
 		if (partx<CELL || partx>=XRES-CELL || party<CELL || party>=YRES-CELL)
+		{
+			// the second pass skips it, so it must not take a slot
 			kill_part(i);
+			continue;
+		}
 		if ((int)pmap_count[party][partx] <= stackEditDepth)
 			numInBack++;
 		pmap_count[party][partx]++;
@@ -5030,7 +5047,12 @@ void Simulation::BeforeStackEdit()
 		if (parts[i].type == PT_SOAP)
 			soapList.insert(std::pair<unsigned int, unsigned int>(i, newId));
 	}
-	memcpy(parts, stackReorderParts, sizeof(parts));
+	// only copy the ranges that were filled, and clear whatever was live in between
+	memcpy(parts, stackReorderParts, sizeof(Particle) * frontPtr);
+	memcpy(&parts[backBegin], &stackReorderParts[backBegin], sizeof(Particle) * numInBack);
+	int clearEnd = std::min(backBegin, oldLastActiveIndex + 1);
+	if (clearEnd > frontPtr)
+		memset(&parts[frontPtr], 0, sizeof(Particle) * (clearEnd - frontPtr));
 	FixSoapLinks(soapList);
 	parts_lastActiveIndex = NPART-1;
 	RecalcFreeParticles(false);
@@ -5062,9 +5084,150 @@ void Simulation::AfterStackEdit()
 	RecalcFreeParticles(false);
 }
 
+// Same generation as the generic path below, on golBoard. Only works while
+// every live cell is of the same kind, which leaves a new cell nothing to
+// choose between, and is the particle in pmap at its position. It also
+// leaves cells whose tmp2 is about to drop back to the live value to the
+// generic path. Returns false without changing anything in those cases.
+bool Simulation::SimulateGoLBoard()
+{
+	bool anyLive = false;
+	unsigned int liveType = 0, liveRuleset = 0;
+	golDying.clear();
+	for (int i = 0; i <= parts_lastActiveIndex; ++i)
+	{
+		auto &part = parts[i];
+		if (part.type != PT_LIFE)
+		{
+			continue;
+		}
+		auto x = int(part.x + 0.5f);
+		auto y = int(part.y + 0.5f);
+		if (x < CELL || y < CELL || x >= XRES - CELL || y >= YRES - CELL)
+		{
+			continue;
+		}
+		unsigned int golnum = part.ctype;
+		unsigned int ruleset = golnum;
+		if (golnum < NGOL)
+		{
+			ruleset = builtinGol[golnum].ruleset;
+		}
+		int liveTmp2 = int((ruleset >> 17) & 0xF) + 1;
+		if (part.tmp2 == liveTmp2)
+		{
+			if ((anyLive && golnum != liveType) || pmap[y][x] != PMAP(i, PT_LIFE) || !golBoard.Set(x, y))
+			{
+				golBoard.Clear();
+				return false;
+			}
+			anyLive = true;
+			liveType = golnum;
+			liveRuleset = ruleset;
+		}
+		else if (part.tmp2 == liveTmp2 + 1)
+		{
+			golBoard.Clear();
+			return false;
+		}
+		else
+		{
+			golDying.push_back(i);
+		}
+	}
+
+	// positions to look for dead cells at, killed in the same order as the
+	// generic path does
+	golKills.clear();
+	for (auto i : golDying)
+	{
+		auto &part = parts[i];
+		auto x = int(part.x + 0.5f);
+		auto y = int(part.y + 0.5f);
+		if (!(bmap[y / CELL][x / CELL] == WL_STASIS && emap[y / CELL][x / CELL] < 8))
+		{
+			part.tmp2 -= 1;
+		}
+		if (part.tmp2 <= 0)
+		{
+			golKills.push_back(y * XRES + x);
+		}
+	}
+
+	golChanges.clear();
+	if (anyLive)
+	{
+		golBoard.Evolve(liveRuleset, golChanges);
+	}
+	for (auto &change : golChanges)
+	{
+		int x = change.x, y = change.y;
+		if (bmap[y / CELL][x / CELL] == WL_STASIS && emap[y / CELL][x / CELL] < 8)
+		{
+			continue;
+		}
+		int r = pmap[y][x];
+		if (!change.born)
+		{
+			// * Start death sequence.
+			auto &part = parts[ID(r)];
+			part.tmp2 -= 1;
+			if (part.tmp2 <= 0)
+			{
+				golKills.push_back(y * XRES + x);
+			}
+		}
+		else if (!r)
+		{
+			// * Colour and tmp come from the first live neighbour in particle
+			//   order, like the generic path's neighbour list.
+			int sample = -1;
+			for (int yy = -1; yy <= 1; ++yy)
+			{
+				for (int xx = -1; xx <= 1; ++xx)
+				{
+					int ax = ((x + xx + XRES - 3 * CELL) % (XRES - 2 * CELL)) + CELL;
+					int ay = ((y + yy + YRES - 3 * CELL) % (YRES - 2 * CELL)) + CELL;
+					if ((xx || yy) && golBoard.Get(ax, ay) && (sample < 0 || int(ID(pmap[ay][ax])) < sample))
+					{
+						sample = ID(pmap[ay][ax]);
+					}
+				}
+			}
+			int i = create_part(-1, x, y, PT_LIFE, liveType | 0x200000);
+			if (i >= 0)
+			{
+				parts[i].dcolour = parts[sample].dcolour;
+				parts[i].tmp = parts[sample].tmp;
+				if (parts[i].tmp2 <= 0)
+				{
+					golKills.push_back(y * XRES + x);
+				}
+			}
+		}
+	}
+	golBoard.Clear();
+
+	std::sort(golKills.begin(), golKills.end());
+	golKills.erase(std::unique(golKills.begin(), golKills.end()), golKills.end());
+	for (auto position : golKills)
+	{
+		int r = pmap[position / XRES][position % XRES];
+		if (r && TYP(r) == PT_LIFE && parts[ID(r)].tmp2 <= 0)
+		{
+			kill_part(ID(r));
+		}
+	}
+	return true;
+}
+
 void Simulation::SimulateGoL()
 {
 	CGOL = 0;
+	if (SimulateGoLBoard())
+	{
+		return;
+	}
 	for (int i = 0; i <= parts_lastActiveIndex; ++i)
 	{
 		auto &part = parts[i];
@@ -5242,9 +5405,10 @@ void Simulation::CheckStacking()
 {
 	bool excessive_stacking_found = false;
 	force_stacking_check = false;
-	for (int y = 0; y < YRES; y++)
+	// nothing outside stackingBounds has enough particles to bother with
+	for (int y = stackingBounds[1]; y <= stackingBounds[3]; y++)
 	{
-		for (int x = 0; x < XRES; x++)
+		for (int x = stackingBounds[0]; x <= stackingBounds[2]; x++)
 		{
 			// Use a threshold, since some particle stacking can be normal (e.g. BIZR + FILT)
 			// Setting pmap_count[y][x] > NPART means BHOL will form in that spot
@@ -5299,19 +5463,265 @@ void Simulation::CheckStacking()
 	}
 }
 
+void Simulation::SetParallelHeat(int threads)
+{
+#ifdef REALISTIC
+	// latent heat needs the per particle sums from the particle loop
+	threads = 0;
+#endif
+	parallel_heat = threads > 0;
+	if (parallel_heat)
+	{
+		heatThreadPool.SetThreads(threads);
+		heatTemp.resize(NPART);
+		heatConducted.resize(NPART);
+		std::fill(heatConducted.begin(), heatConducted.end(), 0);
+	}
+	else
+	{
+		heatThreadPool.SetThreads(1);
+		heatTemp = std::vector<float>();
+		heatConducted = std::vector<unsigned char>();
+	}
+}
+
+// whether heat flows between particle i of type t and the particle at pmap entry r
+inline bool Simulation::HeatConducts(int t, int i, int r)
+{
+	int rt = TYP(r);
+	return rt && elements[rt].HeatConduct && (rt!=PT_HSWC||parts[ID(r)].life==10)
+	        && (t!=PT_FILT||(rt!=PT_BRAY&&rt!=PT_BIZR&&rt!=PT_BIZRG))
+	        && (rt!=PT_FILT||(t!=PT_BRAY&&t!=PT_PHOT&&t!=PT_BIZR&&t!=PT_BIZRG))
+	        && (t!=PT_ELEC||rt!=PT_DEUT)
+	        && (t!=PT_DEUT||rt!=PT_ELEC)
+	        && (t!=PT_HSWC || rt!=PT_FILT || parts[i].tmp != 1)
+	        && (t!=PT_FILT || rt!=PT_HSWC || parts[ID(r)].tmp != 1);
+}
+
+// splitmix64, so that each particle gets the same roll whichever thread handles it
+static inline uint64_t heatRoll(uint64_t seed, int i)
+{
+	uint64_t z = seed + uint64_t(i) * 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+// Heat conduction for every particle at once, in two passes so that nothing
+// reads a temperature another thread might be writing. The first pass works
+// out the average that each conducting particle would set itself and its
+// neighbours to in the particle loop. The second gives every particle the
+// mean of the averages that reached it, rather than whichever came last.
+// Ambient heat and temperature transitions are still done in UpdateParticles.
+void Simulation::ConductHeat()
+{
+	SimulationTimings::Scope scope(timings, SimulationTimings::PHASE_HEAT);
+	uint64_t seed = (uint64_t(RNG::Ref().gen()) << 32) | RNG::Ref().gen();
+	int count = parts_lastActiveIndex + 1;
+	auto inBounds = [this](int i, int &x, int &y) {
+		x = (int)(parts[i].x+0.5f);
+		y = (int)(parts[i].y+0.5f);
+		// particles that are about to be killed or are in stasis are left alone
+		if (x<CELL || y<CELL || x>=XRES-CELL || y>=YRES-CELL)
+			return false;
+		return !(bmap[y/CELL][x/CELL] == WL_STASIS && emap[y/CELL][x/CELL]<8);
+	};
+	heatThreadPool.ParallelFor(count, [this, seed, &inBounds](int start, int end) {
+		int x, y;
+		for (int i = start; i < end; i++)
+		{
+			heatConducted[i] = 0;
+			int t = parts[i].type;
+			if (!t || !inBounds(i, x, y))
+				continue;
+			float gel_scale = 1.0f;
+			if (t==PT_GEL)
+				gel_scale = parts[i].tmp*2.55f;
+			int conduct = int(elements[t].HeatConduct*gel_scale);
+			if ((t==PT_HSWC && parts[i].life!=10) || conduct < 0 || heatRoll(seed, i) % 250 >= (unsigned int)conduct)
+				continue;
+
+			float c_heat = 0.0f;
+			int h_count = 0;
+			for (int nx=-1; nx<2; nx++)
+				for (int ny=-1; ny<2; ny++)
+				{
+					int r = pmap[y+ny][x+nx];
+					if ((nx || ny) && r && HeatConducts(t, i, r))
+					{
+						c_heat += parts[ID(r)].temp;
+						h_count++;
+					}
+				}
+			heatTemp[i] = restrict_flt((c_heat+parts[i].temp)/(h_count+1), MIN_TEMP, MAX_TEMP);
+			heatConducted[i] = 1;
+		}
+	});
+	heatThreadPool.ParallelFor(count, [this, &inBounds](int start, int end) {
+		int x, y;
+		for (int i = start; i < end; i++)
+		{
+			int t = parts[i].type;
+			if (!t || !inBounds(i, x, y))
+				continue;
+			float c_heat = 0.0f;
+			int h_count = 0;
+			if (heatConducted[i])
+			{
+				c_heat += heatTemp[i];
+				h_count++;
+			}
+			// only the particle in pmap is seen as a neighbour by the others
+			int self = PMAP(i, t);
+			if (pmap[y][x] == self)
+			{
+				for (int nx=-1; nx<2; nx++)
+					for (int ny=-1; ny<2; ny++)
+					{
+						int r = pmap[y+ny][x+nx];
+						if ((nx || ny) && r && heatConducted[ID(r)] && HeatConducts(TYP(r), ID(r), self))
+						{
+							c_heat += heatTemp[ID(r)];
+							h_count++;
+						}
+					}
+			}
+			if (h_count)
+				parts[i].temp = c_heat/h_count;
+		}
+	});
+}
+
+void Simulation::SetChunkSleep(bool enable)
+{
+	chunk_sleep = enable;
+	// start with everything awake, the first UpdateChunkSleep records the current state
+	for (int cy = 0; cy < SLEEPCHUNKS_Y; cy++)
+		for (int cx = 0; cx < SLEEPCHUNKS_X; cx++)
+		{
+			sleepChunks[cy][cx].hash = 0;
+			sleepChunks[cy][cx].temp = 0.0f;
+			sleepChunks[cy][cx].air = 0.0f;
+			sleepChunks[cy][cx].quietFrames = 0;
+		}
+	sleepSettingsHash = 0;
+}
+
+void Simulation::WakeChunks(int x1, int y1, int x2, int y2)
+{
+	int cx1 = std::max(x1/SLEEPCHUNK-1, 0), cy1 = std::max(y1/SLEEPCHUNK-1, 0);
+	int cx2 = std::min(x2/SLEEPCHUNK+1, SLEEPCHUNKS_X-1), cy2 = std::min(y2/SLEEPCHUNK+1, SLEEPCHUNKS_Y-1);
+	for (int cy = cy1; cy <= cy2; cy++)
+		for (int cx = cx1; cx <= cx2; cx++)
+			sleepChunks[cy][cx].quietFrames = 0;
+}
+
+void Simulation::WakeAllChunks()
+{
+	for (int cy = 0; cy < SLEEPCHUNKS_Y; cy++)
+		for (int cx = 0; cx < SLEEPCHUNKS_X; cx++)
+			sleepChunks[cy][cx].quietFrames = 0;
+}
+
+void Simulation::UpdateChunkSleep()
+{
+	unsigned int settingsHash = 2166136261U;
+	int ambientAirTemp;
+	memcpy(&ambientAirTemp, &air->ambientAirTemp, sizeof(ambientAirTemp));
+	int settings[] = { gravityMode, air->airMode, ambientAirTemp, edgeMode, legacy_enable, aheat_enable, water_equal_test, grav->IsEnabled() };
+	for (int setting : settings)
+		settingsHash = (settingsHash ^ (unsigned int)setting) * 16777619U;
+	if (settingsHash != sleepSettingsHash)
+	{
+		sleepSettingsHash = settingsHash;
+		WakeAllChunks();
+	}
+
+	// sum a hash of each particle's position and state per chunk, so anything
+	// appearing, moving or changing type, life, ctype or tmp changes the chunk's hash;
+	// temperature and air are summed and compared against a threshold instead
+	unsigned int hash[SLEEPCHUNKS_Y][SLEEPCHUNKS_X] = {};
+	float temp[SLEEPCHUNKS_Y][SLEEPCHUNKS_X] = {};
+	float airSum[SLEEPCHUNKS_Y][SLEEPCHUNKS_X] = {};
+	for (int i = 0; i <= parts_lastActiveIndex; i++)
+	{
+		int t = parts[i].type;
+		if (!t)
+			continue;
+		int x = (int)(parts[i].x+0.5f);
+		int y = (int)(parts[i].y+0.5f);
+		if (x<0 || y<0 || x>=XRES || y>=YRES)
+			continue;
+		int values[] = { t, x, y, parts[i].life, parts[i].ctype, parts[i].tmp, parts[i].tmp2 };
+		unsigned int h = 2166136261U;
+		for (int value : values)
+			h = (h ^ (unsigned int)value) * 16777619U;
+		hash[y/SLEEPCHUNK][x/SLEEPCHUNK] += h;
+		temp[y/SLEEPCHUNK][x/SLEEPCHUNK] += parts[i].temp;
+	}
+	for (int y = 0; y < YRES/CELL; y++)
+		for (int x = 0; x < XRES/CELL; x++)
+		{
+			int cy = y*CELL/SLEEPCHUNK, cx = x*CELL/SLEEPCHUNK;
+			airSum[cy][cx] += pv[y][x] + std::abs(vx[y][x]) + std::abs(vy[y][x]);
+			// Newtonian gravity pulls on particles like air does
+			if (grav->IsEnabled())
+				airSum[cy][cx] += std::abs(gravx[y*(XRES/CELL)+x]) + std::abs(gravy[y*(XRES/CELL)+x]);
+			if (aheat_enable)
+				temp[cy][cx] += hv[y][x];
+		}
+
+	bool changed[SLEEPCHUNKS_Y][SLEEPCHUNKS_X];
+	for (int cy = 0; cy < SLEEPCHUNKS_Y; cy++)
+		for (int cx = 0; cx < SLEEPCHUNKS_X; cx++)
+		{
+			SleepChunk &chunk = sleepChunks[cy][cx];
+			changed[cy][cx] = chunk.hash != hash[cy][cx] || std::abs(chunk.temp - temp[cy][cx]) > SLEEPCHUNK_TEMP || std::abs(chunk.air - airSum[cy][cx]) > SLEEPCHUNK_AIR;
+			if (changed[cy][cx])
+			{
+				chunk.hash = hash[cy][cx];
+				chunk.temp = temp[cy][cx];
+				chunk.air = airSum[cy][cx];
+			}
+		}
+	// a change keeps the chunk and its neighbours awake
+	for (int cy = 0; cy < SLEEPCHUNKS_Y; cy++)
+		for (int cx = 0; cx < SLEEPCHUNKS_X; cx++)
+		{
+			bool nearChange = false;
+			for (int ny = std::max(cy-1, 0); ny <= std::min(cy+1, SLEEPCHUNKS_Y-1); ny++)
+				for (int nx = std::max(cx-1, 0); nx <= std::min(cx+1, SLEEPCHUNKS_X-1); nx++)
+					nearChange |= changed[ny][nx];
+			SleepChunk &chunk = sleepChunks[cy][cx];
+			if (nearChange)
+				chunk.quietFrames = 0;
+			else if (chunk.quietFrames < SLEEPCHUNK_FRAMES)
+				chunk.quietFrames++;
+		}
+}
+
 //updates pmap, gol, and some other simulation stuff (but not particles)
 void Simulation::BeforeSim()
 {
 	if (!sys_pause||framerender)
 	{
-		air->update_air();
+		{
+			SimulationTimings::Scope scope(timings, SimulationTimings::PHASE_AIR);
+			air->update_air();
+		}
 
 		if(aheat_enable)
+		{
+			SimulationTimings::Scope scope(timings, SimulationTimings::PHASE_AIRH);
 			air->update_airh();
+		}
 
 		if(grav->IsEnabled())
 		{
-			grav->gravity_update_async();
+			{
+				SimulationTimings::Scope scope(timings, SimulationTimings::PHASE_GRAVITY);
+				grav->gravity_update_async();
+			}
 
 			//Get updated buffer pointers for gravity
 			gravx = grav->gravx;
@@ -5341,6 +5751,8 @@ void Simulation::BeforeSim()
 		gravWallChanged = false;
 	}
 
+	// elementBounds is only up to date if the particle maps were just rebuilt
+	bool elementBoundsValid = debug_currentParticle == 0;
 	if (debug_currentParticle == 0)
 		RecalcFreeParticles(true);
 
@@ -5353,7 +5765,12 @@ void Simulation::BeforeSim()
 			for (x = 0; x < XRES/CELL; x++)
 			{
 				if (emap[y][x])
+				{
 					emap[y][x] --;
+					// electrified walls switch at 8 and 0
+					if (emap[y][x] == 7 || !emap[y][x])
+						WakeChunks(x*CELL, y*CELL, x*CELL+CELL-1, y*CELL+CELL-1);
+				}
 				air->bmap_blockair[y][x] = (bmap[y][x]==WL_WALL || bmap[y][x]==WL_WALLELEC || bmap[y][x]==WL_BLOCKAIR || (bmap[y][x]==WL_EWALL && !emap[y][x]));
 				air->bmap_blockairh[y][x] = (bmap[y][x]==WL_WALL || bmap[y][x]==WL_WALLELEC || bmap[y][x]==WL_BLOCKAIR || bmap[y][x]==WL_GRAV || (bmap[y][x]==WL_EWALL && !emap[y][x])) ? 0x8:0;
 			}
@@ -5362,16 +5779,26 @@ void Simulation::BeforeSim()
 		// check for stacking and create BHOL if found
 		if (force_stacking_check || RNG::Ref().chance(1, 10))
 		{
+			SimulationTimings::Scope scope(timings, SimulationTimings::PHASE_STACKING);
 			CheckStacking();
 		}
 
 		// LOVE and LOLZ element handling
 		if (elementCount[PT_LOVE] > 0 || elementCount[PT_LOLZ] > 0)
 		{
+			SimulationTimings::Scope scope(timings, SimulationTimings::PHASE_LOVELOLZ);
 			int nx, nnx, ny, nny, r, rt;
-			for (ny=0; ny<YRES-4; ny++)
+			int x1 = 0, y1 = 0, x2 = XRES-5, y2 = YRES-5;
+			if (elementBoundsValid)
 			{
-				for (nx=0; nx<XRES-4; nx++)
+				x1 = std::min(elementBounds[PT_LOVE][0], elementBounds[PT_LOLZ][0]);
+				y1 = std::min(elementBounds[PT_LOVE][1], elementBounds[PT_LOLZ][1]);
+				x2 = std::min(std::max(elementBounds[PT_LOVE][2], elementBounds[PT_LOLZ][2]), XRES-5);
+				y2 = std::min(std::max(elementBounds[PT_LOVE][3], elementBounds[PT_LOLZ][3]), YRES-5);
+			}
+			for (ny=y1; ny<=y2; ny++)
+			{
+				for (nx=x1; nx<=x2; nx++)
 				{
 					r=pmap[ny][nx];
 					if (!r)
@@ -5438,9 +5865,18 @@ void Simulation::BeforeSim()
 		// make WIRE work
 		if(elementCount[PT_WIRE] > 0)
 		{
-			for (int nx = 0; nx < XRES; nx++)
+			SimulationTimings::Scope scope(timings, SimulationTimings::PHASE_WIRE);
+			int x1 = 0, y1 = 0, x2 = XRES-1, y2 = YRES-1;
+			if (elementBoundsValid)
+			{
+				x1 = elementBounds[PT_WIRE][0];
+				y1 = elementBounds[PT_WIRE][1];
+				x2 = elementBounds[PT_WIRE][2];
+				y2 = elementBounds[PT_WIRE][3];
+			}
+			for (int nx = x1; nx <= x2; nx++)
 			{
-				for (int ny = 0; ny < YRES; ny++)
+				for (int ny = y1; ny <= y2; ny++)
 				{
 					int r = pmap[ny][nx];
 					if (!r)
@@ -5454,6 +5890,7 @@ void Simulation::BeforeSim()
 		// update PPIP tmp?
 		if (Element_PPIP_ppip_changed)
 		{
+			SimulationTimings::Scope scope(timings, SimulationTimings::PHASE_PPIP);
 			for (int i = 0; i <= parts_lastActiveIndex; i++)
 			{
 				if (parts[i].type==PT_PPIP)
@@ -5469,6 +5906,7 @@ void Simulation::BeforeSim()
 		// GSPEED is frames per generation
 		if (elementCount[PT_LIFE]>0 && ++CGOL>=GSPEED)
 		{
+			SimulationTimings::Scope scope(timings, SimulationTimings::PHASE_GOL);
 			SimulateGoL();
 		}
 
@@ -5489,6 +5927,14 @@ void Simulation::BeforeSim()
 		if (!player2.spwn && player2.spawnID >= 0)
 			create_part(-1, (int)parts[player2.spawnID].x, (int)parts[player2.spawnID].y, PT_STKM2);
 
+		if (chunk_sleep)
+			UpdateChunkSleep();
+
+#ifndef REALISTIC
+		if (parallel_heat && !legacy_enable)
+			ConductHeat();
+#endif
+
 		// particle update happens right after this function (called separately)
 	}
 }
@@ -5527,6 +5973,7 @@ Simulation::Simulation():
 	stackToolNotifShown(false),
 	debug_currentParticle(0),
 	needReloadParticleOrder(false),
+	stackIndexValid(false),
 	ISWIRE(0),
 	force_stacking_check(false),
 	emp_decor(0),
@@ -5541,6 +5988,8 @@ Simulation::Simulation():
 	gravityMode(0),
 	legacy_enable(0),
 	aheat_enable(0),
+	parallel_heat(false),
+	chunk_sleep(false),
 	water_equal_test(0),
 	subframe_mode(false),
 	sys_pause(0),
@@ -15,12 +15,25 @@
 #include "BuiltinGOL.h"
 #include "MenuSection.h"
 #include "CoordStack.h"
+#include "GOLBoard.h"
 #include "Sample.h"
+#include "SimulationTimings.h"
+#include "common/ThreadPool.h"
 
 #include "Element.h"
 
 #define CHANNELS ((int)(MAX_TEMP-73)/100+2)
 
+// chunk sleep mode: particles in a chunk stop being updated once the chunk
+// and its neighbours have been unchanged for SLEEPCHUNK_FRAMES frames
+#define SLEEPCHUNK 16
+#define SLEEPCHUNKS_X ((XRES+SLEEPCHUNK-1)/SLEEPCHUNK)
+#define SLEEPCHUNKS_Y ((YRES+SLEEPCHUNK-1)/SLEEPCHUNK)
+#define SLEEPCHUNK_FRAMES 30
+// how far the summed temperature and air of a chunk may drift before it wakes up
+#define SLEEPCHUNK_TEMP 1.0f
+#define SLEEPCHUNK_AIR 0.5f
+
 class Snapshot;
 class SimTool;
 class Brush;
@@ -56,6 +69,7 @@ public:
 	Particle stackReorderParts[NPART];
 
 	SimulationSample sample;
+	SimulationTimings timings;
 	int stackEditDepth;
 	// configToolSample will change the stack sample
 	// but not the pmap sample during UpdateSample
@@ -71,6 +85,7 @@ public:
 	int debug_currentParticle;
 	bool debug_interestingChangeOccurred;
 	bool needReloadParticleOrder;
+	bool stackIndexValid;
 	int parts_lastActiveIndex;
 	int pfree;
 	int NUM_PARTS;
@@ -98,6 +113,10 @@ public:
 	int CGOL;
 	int GSPEED;
 	unsigned int gol[YRES][XRES][5];
+	// used instead of gol while all live cells follow the same rule
+	GOLBoard golBoard;
+	std::vector<GOLBoard::Change> golChanges;
+	std::vector<int> golDying, golKills;
 	//Air sim
 	float (*vx)[XRES/CELL];
 	float (*vy)[XRES/CELL];
@@ -118,11 +137,37 @@ public:
 	int pmap[YRES][XRES];
 	int photons[YRES][XRES];
 	unsigned int pmap_count[YRES][XRES];
+	// rebuilt along with the maps above by RecalcFreeParticles, as { x1, y1, x2, y2 },
+	// empty if x1 > x2: where each element's particles are, and where pmap_count is over 5
+	int elementBounds[PT_NUM][4];
+	int stackingBounds[4];
+	// built on demand by BuildStackIndex: the highest particle ID at each pixel
+	// or -1, and for each particle the next lower ID at the same pixel or -1
+	int stackIndexHead[YRES][XRES];
+	int stackIndexNext[NPART];
 	//Simulation Settings
 	int edgeMode;
 	int gravityMode;
 	int legacy_enable;
 	int aheat_enable;
+	// conduct heat in a separate multithreaded pass before the particle loop
+	bool parallel_heat;
+	ThreadPool heatThreadPool;
+	std::vector<float> heatTemp;
+	std::vector<unsigned char> heatConducted;
+	bool chunk_sleep;
+	struct SleepChunk
+	{
+		// state of the chunk the last time anything in it changed
+		unsigned int hash;
+		float temp;
+		float air;
+		int quietFrames;
+	};
+	SleepChunk sleepChunks[SLEEPCHUNKS_Y][SLEEPCHUNKS_X];
+	// hash of the settings every particle reacts to, such as gravity and air
+	// modes, a change to any of them wakes every chunk
+	unsigned int sleepSettingsHash;
 	int water_equal_test;
 	bool subframe_mode;
 	int sys_pause;
@@ -143,6 +188,9 @@ public:
 
 	Snapshot * CreateSnapshot();
 	void Restore(const Snapshot & snap);
+	// copies just what the renderer reads, for rendering from a copy of this
+	// frame while the next one is simulated
+	void CopyRenderState(const Simulation & from);
 
 	int is_blocking(int t, int x, int y);
 	int is_boundary(int pt, int x, int y);
@@ -183,8 +231,23 @@ public:
 	void CompleteDebugUpdateParticles();
 	void UpdateParticles(int start, int end);
 	void SimulateGoL();
+	bool SimulateGoLBoard();
+	void ClearBounds(int *bounds);
+	void ExtendBounds(int *bounds, int x, int y);
 	void RecalcFreeParticles(bool do_life_dec);
+	void BuildStackIndex();
+	// anything that moves, creates or kills particles without going through
+	// create_part, kill_part or UpdateParticles has to call this
+	void InvalidateStackIndex() {
+		stackIndexValid = false;
+	}
+	// the first particle in the stack at x, y, follow stackIndexNext for the rest
+	int StackIndexHead(int x, int y) {
+		BuildStackIndex();
+		return stackIndexHead[y][x];
+	}
 	void FixSoapLinks(std::map<unsigned int, unsigned int> &soapList);
+	bool ReloadParticleOrderIncremental();
 	void ReloadParticleOrder();
 	// run BeforeStackEdit before drawing to target the stack edit depth;
 	// run AfterStackEdit when done
@@ -192,6 +255,21 @@ public:
 	void BeforeStackEdit();
 	void AfterStackEdit();
 	void CheckStacking();
+	void SetParallelHeat(int threads);
+	void SetChunkSleep(bool enable);
+	void WakeChunk(int x, int y) {
+		sleepChunks[y/SLEEPCHUNK][x/SLEEPCHUNK].quietFrames = 0;
+	}
+	// for walls and air, which particles in the next chunk react to as well:
+	// wakes the chunks the pixel area touches and their neighbours
+	void WakeChunks(int x1, int y1, int x2, int y2);
+	void WakeAllChunks();
+	bool ChunkAsleep(int cx, int cy) {
+		return sleepChunks[cy][cx].quietFrames >= SLEEPCHUNK_FRAMES;
+	}
+	void UpdateChunkSleep();
+	bool HeatConducts(int t, int i, int r);
+	void ConductHeat();
 	void BeforeSim();
 	void AfterSim();
 	void rotate_area(int area_x, int area_y, int area_w, int area_h, int invert);
@@ -0,0 +1,44 @@
+#include "SimulationTimings.h"
+
+#include <algorithm>
+
+SimulationTimings::SimulationTimings():
+	enabled(false),
+	elementsEnabled(false)
+{
+	Reset();
+	ResetElements();
+}
+
+void SimulationTimings::Reset()
+{
+	std::fill(nanoseconds, nanoseconds + PHASE_NUM, 0);
+	std::fill(calls, calls + PHASE_NUM, 0);
+}
+
+void SimulationTimings::ResetElements()
+{
+	std::fill(elementNanoseconds, elementNanoseconds + PT_NUM, 0);
+	std::fill(elementLuaNanoseconds, elementLuaNanoseconds + PT_NUM, 0);
+	std::fill(elementCalls, elementCalls + PT_NUM, 0);
+}
+
+const char *SimulationTimings::PhaseName(int phase)
+{
+	static const char *names[PHASE_NUM] = {
+		"air",
+		"ambient heat",
+		"gravity",
+		"LOVE/LOLZ",
+		"WIRE",
+		"PPIP",
+		"stacking",
+		"GoL",
+		"heat",
+		"particles",
+		"render",
+	};
+	if (phase < 0 || phase >= PHASE_NUM)
+		return "unknown";
+	return names[phase];
+}
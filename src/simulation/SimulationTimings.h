@@ -0,0 +1,112 @@
+#ifndef SIMULATIONTIMINGS_H
+#define SIMULATIONTIMINGS_H
+#include "Config.h"
+
+#include <chrono>
+#include <cstdint>
+
+#include "ElementDefs.h"
+
+// Wall-clock time spent in each phase of a frame, accumulated until Reset.
+// Costs nothing but a branch per phase while disabled.
+class SimulationTimings
+{
+public:
+	enum Phase
+	{
+		PHASE_AIR,
+		PHASE_AIRH,
+		PHASE_GRAVITY,
+		PHASE_LOVELOLZ,
+		PHASE_WIRE,
+		PHASE_PPIP,
+		PHASE_STACKING,
+		PHASE_GOL,
+		PHASE_HEAT,
+		PHASE_PARTICLES,
+		PHASE_RENDER,
+		PHASE_NUM
+	};
+
+	bool enabled;
+	uint64_t nanoseconds[PHASE_NUM];
+	unsigned int calls[PHASE_NUM];
+
+	void Reset();
+	static const char *PhaseName(int phase);
+
+	// Per element update cost, kept apart from the phases since timing every
+	// particle is far more expensive than timing a whole phase.
+	bool elementsEnabled;
+	uint64_t elementNanoseconds[PT_NUM];
+	uint64_t elementLuaNanoseconds[PT_NUM];
+	unsigned int elementCalls[PT_NUM];
+
+	void ResetElements();
+
+	SimulationTimings();
+
+	class Scope
+	{
+		SimulationTimings &timings;
+		int phase;
+		bool active;
+		std::chrono::steady_clock::time_point start;
+
+	public:
+		Scope(SimulationTimings &timings, int phase):
+			timings(timings),
+			phase(phase),
+			active(timings.enabled)
+		{
+			if (active)
+				start = std::chrono::steady_clock::now();
+		}
+
+		~Scope()
+		{
+			if (active)
+			{
+				timings.nanoseconds[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+				timings.calls[phase]++;
+			}
+		}
+	};
+
+	class ElementScope
+	{
+		SimulationTimings &timings;
+		int type;
+		bool lua;
+		bool active;
+		std::chrono::steady_clock::time_point start;
+
+	public:
+		ElementScope(SimulationTimings &timings, int type, bool lua = false):
+			timings(timings),
+			type(type),
+			lua(lua),
+			active(timings.elementsEnabled)
+		{
+			if (active)
+				start = std::chrono::steady_clock::now();
+		}
+
+		~ElementScope()
+		{
+			if (active)
+			{
+				uint64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+				if (lua)
+					timings.elementLuaNanoseconds[type] += nanoseconds;
+				else
+				{
+					timings.elementNanoseconds[type] += nanoseconds;
+					timings.elementCalls[type]++;
+				}
+			}
+		}
+	};
+};
+
+#endif
@@ -3,6 +3,8 @@
 #include <vector>
 
 #include "Particle.h"
+#include "Sign.h"
+#include "Stickman.h"
 #include "json/json.h"
 
 class Snapshot
@@ -63,4 +65,15 @@ public:
 	{
 
 	}
+
+	// bytes of memory held, not counting signs and authors
+	size_t Size() const
+	{
+		size_t floats = AirPressure.size() + AirVelocityX.size() + AirVelocityY.size() + AmbientHeat.size() +
+			GravVelocityX.size() + GravVelocityY.size() + GravValue.size() + GravMap.size() +
+			FanVelocityX.size() + FanVelocityY.size();
+		return sizeof(Snapshot) + floats * sizeof(float) + (BlockMap.size() + ElecMap.size()) +
+			(Particles.size() + PortalParticles.size()) * sizeof(Particle) + WirelessData.size() * sizeof(int) +
+			stickmen.size() * sizeof(playerst) + signs.size() * sizeof(sign);
+	}
 };
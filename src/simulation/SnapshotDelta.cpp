@@ -0,0 +1,234 @@
+#include "SnapshotDelta.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <zlib.h>
+
+// arrays are compared in blocks of this many bytes, a block that differs at
+// all is stored whole
+#define SNAPSHOTDELTA_BLOCK 64
+
+static void putU32(std::vector<unsigned char> &out, uint32_t value)
+{
+	unsigned char bytes[4];
+	memcpy(bytes, &value, 4);
+	out.insert(out.end(), bytes, bytes + 4);
+}
+
+static uint32_t getU32(const unsigned char *&in)
+{
+	uint32_t value;
+	memcpy(&value, in, 4);
+	in += 4;
+	return value;
+}
+
+// each field is its old and new item counts, then runs of changed bytes as
+// the number of unchanged bytes skipped, the run length and the XORed bytes,
+// ending with an empty run; bytes past the end of the shorter array count as 0
+template<class T>
+static void diffField(std::vector<unsigned char> &out, const std::vector<T> &oldField, const std::vector<T> &newField)
+{
+	putU32(out, oldField.size());
+	putU32(out, newField.size());
+	const unsigned char *oldBytes = reinterpret_cast<const unsigned char *>(oldField.data());
+	const unsigned char *newBytes = reinterpret_cast<const unsigned char *>(newField.data());
+	size_t oldSize = oldField.size() * sizeof(T), newSize = newField.size() * sizeof(T);
+	size_t commonSize = std::min(oldSize, newSize), size = std::max(oldSize, newSize);
+	auto blockChanged = [&](size_t begin) {
+		size_t end = begin + SNAPSHOTDELTA_BLOCK;
+		return end > commonSize || memcmp(oldBytes + begin, newBytes + begin, SNAPSHOTDELTA_BLOCK);
+	};
+
+	size_t lastEnd = 0, begin = 0;
+	while (begin < size)
+	{
+		if (!blockChanged(begin))
+		{
+			begin += SNAPSHOTDELTA_BLOCK;
+			continue;
+		}
+		size_t end = begin + SNAPSHOTDELTA_BLOCK;
+		while (end < size && blockChanged(end))
+			end += SNAPSHOTDELTA_BLOCK;
+		end = std::min(end, size);
+		putU32(out, begin - lastEnd);
+		putU32(out, end - begin);
+		size_t outPos = out.size() - begin;
+		out.resize(outPos + end);
+		size_t i = begin;
+		for (; i < std::min(end, commonSize); i++)
+			out[outPos + i] = oldBytes[i] ^ newBytes[i];
+		for (; i < end; i++)
+			out[outPos + i] = i < oldSize ? oldBytes[i] : newBytes[i];
+		lastEnd = end;
+		begin = end;
+	}
+	putU32(out, 0);
+	putU32(out, 0);
+}
+
+template<class T>
+static void applyField(const unsigned char *&in, std::vector<T> &field, bool forward)
+{
+	uint32_t oldCount = getU32(in);
+	uint32_t newCount = getU32(in);
+	field.resize(std::max(oldCount, newCount));
+	unsigned char *bytes = reinterpret_cast<unsigned char *>(field.data());
+	size_t pos = 0;
+	while (true)
+	{
+		pos += getU32(in);
+		uint32_t length = getU32(in);
+		if (!length)
+			break;
+		for (uint32_t i = 0; i < length; i++)
+			bytes[pos + i] ^= in[i];
+		in += length;
+		pos += length;
+	}
+	field.resize(forward ? newCount : oldCount);
+}
+
+SnapshotDelta::SnapshotDelta():
+	rawSize(0),
+	compressionDone(false),
+	compressionFailed(false)
+{
+}
+
+SnapshotDelta::~SnapshotDelta()
+{
+	if (compressor.joinable())
+		compressor.join();
+}
+
+std::unique_ptr<SnapshotDelta> SnapshotDelta::FromSnapshots(const Snapshot &oldSnap, const Snapshot &newSnap)
+{
+	std::unique_ptr<SnapshotDelta> delta(new SnapshotDelta());
+	std::vector<unsigned char> &data = delta->data;
+	putU32(data, oldSnap.debug_currentParticle);
+	putU32(data, newSnap.debug_currentParticle);
+	diffField(data, oldSnap.AirPressure, newSnap.AirPressure);
+	diffField(data, oldSnap.AirVelocityX, newSnap.AirVelocityX);
+	diffField(data, oldSnap.AirVelocityY, newSnap.AirVelocityY);
+	diffField(data, oldSnap.AmbientHeat, newSnap.AmbientHeat);
+	diffField(data, oldSnap.Particles, newSnap.Particles);
+	diffField(data, oldSnap.GravVelocityX, newSnap.GravVelocityX);
+	diffField(data, oldSnap.GravVelocityY, newSnap.GravVelocityY);
+	diffField(data, oldSnap.GravValue, newSnap.GravValue);
+	diffField(data, oldSnap.GravMap, newSnap.GravMap);
+	diffField(data, oldSnap.BlockMap, newSnap.BlockMap);
+	diffField(data, oldSnap.ElecMap, newSnap.ElecMap);
+	diffField(data, oldSnap.FanVelocityX, newSnap.FanVelocityX);
+	diffField(data, oldSnap.FanVelocityY, newSnap.FanVelocityY);
+	diffField(data, oldSnap.PortalParticles, newSnap.PortalParticles);
+	diffField(data, oldSnap.WirelessData, newSnap.WirelessData);
+	diffField(data, oldSnap.stickmen, newSnap.stickmen);
+	delta->rawSize = data.size();
+	delta->oldSigns = oldSnap.signs;
+	delta->newSigns = newSnap.signs;
+	delta->oldAuthors = oldSnap.Authors;
+	delta->newAuthors = newSnap.Authors;
+
+	SnapshotDelta *deltaPtr = delta.get();
+	delta->compressor = std::thread([deltaPtr]() { deltaPtr->Compress(); });
+	return delta;
+}
+
+void SnapshotDelta::Compress()
+{
+	uLongf compressedSize = compressBound(rawSize);
+	compressedData.resize(compressedSize);
+	if (compress2(&compressedData[0], &compressedSize, &data[0], rawSize, Z_DEFAULT_COMPRESSION) == Z_OK && compressedSize < rawSize)
+	{
+		compressedData.resize(compressedSize);
+		compressedData.shrink_to_fit();
+	}
+	else
+	{
+		compressionFailed = true;
+		std::vector<unsigned char>().swap(compressedData);
+	}
+	compressionDone = true;
+}
+
+size_t SnapshotDelta::GetSize()
+{
+	size_t size = sizeof(SnapshotDelta) + (oldSigns.size() + newSigns.size()) * sizeof(sign);
+	if (!compressionDone)
+		return size + data.size();
+	if (compressor.joinable())
+	{
+		compressor.join();
+		if (!compressionFailed)
+			std::vector<unsigned char>().swap(data);
+	}
+	return size + data.size() + compressedData.size();
+}
+
+bool SnapshotDelta::GetData(std::vector<unsigned char> &raw)
+{
+	if (compressor.joinable())
+	{
+		compressor.join();
+		if (!compressionFailed)
+			std::vector<unsigned char>().swap(data);
+	}
+	if (compressionFailed)
+	{
+		raw = data;
+		return true;
+	}
+	raw.resize(rawSize);
+	uLongf uncompressedSize = rawSize;
+	if (uncompress(&raw[0], &uncompressedSize, &compressedData[0], compressedData.size()) != Z_OK || uncompressedSize != rawSize)
+	{
+		std::cerr << "SnapshotDelta: undo history data is damaged" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+std::unique_ptr<Snapshot> SnapshotDelta::Apply(const Snapshot &snap, bool forward)
+{
+	std::vector<unsigned char> raw;
+	if (!GetData(raw))
+		return nullptr;
+	std::unique_ptr<Snapshot> result(new Snapshot(snap));
+	const unsigned char *in = &raw[0];
+	int oldDebugParticle = getU32(in);
+	int newDebugParticle = getU32(in);
+	result->debug_currentParticle = forward ? newDebugParticle : oldDebugParticle;
+	applyField(in, result->AirPressure, forward);
+	applyField(in, result->AirVelocityX, forward);
+	applyField(in, result->AirVelocityY, forward);
+	applyField(in, result->AmbientHeat, forward);
+	applyField(in, result->Particles, forward);
+	applyField(in, result->GravVelocityX, forward);
+	applyField(in, result->GravVelocityY, forward);
+	applyField(in, result->GravValue, forward);
+	applyField(in, result->GravMap, forward);
+	applyField(in, result->BlockMap, forward);
+	applyField(in, result->ElecMap, forward);
+	applyField(in, result->FanVelocityX, forward);
+	applyField(in, result->FanVelocityY, forward);
+	applyField(in, result->PortalParticles, forward);
+	applyField(in, result->WirelessData, forward);
+	applyField(in, result->stickmen, forward);
+	result->signs = forward ? newSigns : oldSigns;
+	result->Authors = forward ? newAuthors : oldAuthors;
+	return result;
+}
+
+std::unique_ptr<Snapshot> SnapshotDelta::Forward(const Snapshot &oldSnap)
+{
+	return Apply(oldSnap, true);
+}
+
+std::unique_ptr<Snapshot> SnapshotDelta::Restore(const Snapshot &newSnap)
+{
+	return Apply(newSnap, false);
+}
@@ -0,0 +1,49 @@
+#ifndef SNAPSHOTDELTA_H
+#define SNAPSHOTDELTA_H
+#include "Config.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Snapshot.h"
+
+// The difference between two snapshots, small enough to keep many of them
+// in the undo history. Every array in the snapshot is compared in blocks,
+// and only the blocks that changed are stored, XORed with their old
+// contents, so the same delta can be applied in either direction. Signs and
+// authors are small and not plain data, so both versions are kept whole.
+// Once built, the block data is zlib compressed on a background thread.
+class SnapshotDelta
+{
+	std::vector<unsigned char> data;
+	std::vector<unsigned char> compressedData;
+	size_t rawSize;
+	std::atomic<bool> compressionDone;
+	bool compressionFailed;
+	std::thread compressor;
+
+	std::vector<sign> oldSigns, newSigns;
+	Json::Value oldAuthors, newAuthors;
+
+	SnapshotDelta();
+	void Compress();
+	// waits for the compressor and gets the uncompressed block data; false
+	// if it does not decompress to exactly what was compressed
+	bool GetData(std::vector<unsigned char> &raw);
+	std::unique_ptr<Snapshot> Apply(const Snapshot &snap, bool forward);
+
+public:
+	~SnapshotDelta();
+
+	static std::unique_ptr<SnapshotDelta> FromSnapshots(const Snapshot &oldSnap, const Snapshot &newSnap);
+	// newSnap from oldSnap, or nullptr if the delta is damaged
+	std::unique_ptr<Snapshot> Forward(const Snapshot &oldSnap);
+	// oldSnap from newSnap, or nullptr if the delta is damaged
+	std::unique_ptr<Snapshot> Restore(const Snapshot &newSnap);
+	// bytes of memory held, which drops once compression finishes
+	size_t GetSize();
+};
+
+#endif